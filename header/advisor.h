@@ -0,0 +1,72 @@
+#ifndef ADVISOR_H
+#define ADVISOR_H
+
+#include "ai.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Luồng tìm nước đi chạy nền cho gợi ý và máy tự chơi, để vòng lặp SDL không bao giờ chờ cây tìm kiếm.
+// Luồng chính chỉ giữ khóa trong vài lệnh gán, còn kết quả được đọc bằng result() không chặn.
+//
+// Với ponder, tìm xong bàn cờ hiện tại thì luồng tìm tiếp mọi bàn cờ (nước đi, ô sinh ra) có thể tới
+// trong lúc người chơi còn nghĩ; bàn cờ mới nằm trong số đó thì start() có ngay kết quả.
+class Advisor
+{
+public:
+    Advisor(const SearchLimits &limits, bool ponder = false);
+    ~Advisor();
+
+    // Hủy lượt đang chạy (nếu có) và tìm cho board; không làm gì nếu board đã là bàn cờ đang/đã tìm
+    void start(Board board);
+
+    // Hủy lượt đang chạy, không chờ luồng dừng; các kết quả đã có vẫn giữ
+    void cancel();
+
+    // Chờ luồng dừng hẳn, dùng trước khi đổi dữ liệu mà cây tìm kiếm đang đọc (như bảng đánh giá)
+    void wait();
+
+    // Bỏ kết quả đã có và bộ nhớ ponder, dùng khi chúng không còn đúng (như sau khi đổi trọng số)
+    void forget();
+
+    // true nếu đã có nước đi cho đúng board; move là -1 khi board không còn nước đi
+    bool result(Board board, int &move);
+
+    // Số bàn cờ mới start() nhận khi ponder, và số bàn cờ trong đó đã được tìm sẵn
+    uint64_t ponderLookups() const { return ponderLookups_; }
+    uint64_t ponderHits() const { return ponderHits_; }
+
+private:
+    // 4 hướng x 15 ô trống x 2 loại ô sinh ra
+    static const int PONDER_CAPACITY = 4 * (BOARD_CELLS - 1) * 2;
+
+    void workerLoop();
+    void ponder(Board board, int hint);
+    bool interrupted();
+
+    SearchLimits limits_;
+    bool ponder_;
+    std::atomic<bool> cancel_;
+    std::mutex lock_;
+    std::condition_variable wakeUp_;
+    std::condition_variable idle_;
+    bool quit_;
+    bool pending_;  // có board_ chờ tìm
+    bool running_;  // luồng đang tìm
+    bool targeted_; // board_ là bàn cờ đang chờ, đang tìm hoặc đã có kết quả
+    Board board_;
+    bool known_; // move_ là nước tốt nhất của knownBoard_
+    Board knownBoard_;
+    int move_;
+    Board ponderParent_; // bàn cờ có các bàn cờ kế tiếp đang nằm trong ponderBoards_
+    int ponderCount_;
+    Board ponderBoards_[PONDER_CAPACITY];
+    int8_t ponderMoves_[PONDER_CAPACITY];
+    uint64_t ponderLookups_;
+    uint64_t ponderHits_;
+    std::thread worker_;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef AI_H
+#define AI_H
+
+#include "board.h"
+#include <atomic>
+#include <cstdint>
+
+class TranspositionTable;
+class WorkPool;
+
+// Người chơi máy bằng expectimax trên bàn cờ 4x4 nén 64 bit:
+// nút max chọn 1 trong 4 hướng, nút chance lấy trung bình theo xác suất mọi ô mới có thể sinh.
+
+// Kernel di chuyển dùng trong cây tìm kiếm, để so thông lượng với vòng lặp từng ô
+enum SearchKernel
+{
+    SEARCH_TABLE,
+    SEARCH_SCALAR,
+    SEARCH_SIMD // SSE4.1 không cần bảng tra hàng; CPU không hỗ trợ thì dùng bảng tra
+};
+
+struct SearchLimits
+{
+    int depth;           // số nước đi nhìn trước; với moveMs là độ sâu tối đa của tìm sâu dần
+    uint64_t nodeBudget; // hết ngân sách thì nút chance trả về giá trị đánh giá, 0 là không giới hạn
+    SearchKernel kernel;
+    TranspositionTable *table; // nhớ giá trị nút chance giữa các nhánh, nullptr là không dùng
+    bool canonical;            // khóa bảng là đại diện đối xứng nhỏ nhất, gộp 8 bàn cờ đối xứng vào một mục
+    WorkPool *pool;            // tìm song song khi pool có hơn một luồng
+    int splitPlies;            // số tầng đầu cây (tính cả nút max gốc) được chia thành task
+    float minProbability;      // nút chance có xác suất tích lũy nhỏ hơn thì chỉ đánh giá, không mở tiếp
+    int maxSamples;            // nút chance có nhiều ô trống hơn thì chỉ mở maxSamples ô chọn ngẫu nhiên, 0 là mở hết
+    double moveMs;             // > 0: tìm sâu dần và trả về kết quả lượt sâu nhất xong trước hạn này
+    const std::atomic<bool> *cancel; // luồng khác bật cờ này để dừng lần tìm, kết quả khi đó không dùng được
+
+    SearchLimits()
+        : depth(3), nodeBudget(0), kernel(SEARCH_TABLE), table(nullptr), canonical(true), pool(nullptr), splitPlies(2),
+          minProbability(0), maxSamples(0), moveMs(0), cancel(nullptr)
+    {
+    }
+};
+
+struct SearchStats
+{
+    uint64_t nodes;
+    double ms;
+    int depth;
+    uint64_t ttProbes; // đếm riêng trong mỗi lần tìm để nhiều luồng không tranh nhau một bộ đếm
+    uint64_t ttHits;
+    double overrunMs;  // thời gian vượt quá moveMs, 0 nếu kịp hạn
+
+    SearchStats() : nodes(0), ms(0), depth(0), ttProbes(0), ttHits(0), overrunMs(0) {}
+
+    double nodesPerSecond() const
+    {
+        return ms > 0 ? nodes * 1000.0 / ms : 0;
+    }
+
+    double hitRate() const
+    {
+        return ttProbes ? double(ttHits) / ttProbes : 0;
+    }
+};
+
+struct SearchResult
+{
+    int move; // Direction tốt nhất, -1 nếu không còn nước đi
+    float value;
+    SearchStats stats;
+};
+
+SearchResult searchMove(Board board, const SearchLimits &limits);
+
+struct HeadlessSummary
+{
+    double averageScore;
+    uint64_t moves;
+    uint64_t nodes;
+    double ms;
+};
+
+// Tự chơi games ván không cần cửa sổ; verbose thì in điểm, ô lớn nhất và tốc độ tìm kiếm từng ván
+HeadlessSummary playHeadless(int games, uint64_t seed, const SearchLimits &limits, bool verbose = true);
+
+#endif
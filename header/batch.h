@@ -0,0 +1,23 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "board.h"
+#include "grid_engine.h"
+#include "rng.h"
+
+// Bố cục 8 bit của ván 4x4 khi ô 32768 không còn vừa 4 bit (như EscapeVariant::widen)
+typedef GridEngine<4, 4, WIDE_CELL_BITS>::Grid WideBoard;
+
+// Bước đồng loạt nhiều ván theo kiểu struct-of-arrays, không đụng tới biến toàn cục của giao diện SDL.
+// Với mỗi ván i: đi nước actions[i] (một Direction) trên boards[i]; nếu bàn cờ thay đổi thì sinh ô mới
+// bằng rngs[i]. Ghi ra nextBoards[i], rewards[i] (điểm cộng), done[i] (hết nước đi) và legalMoves[i]
+// (bit d bật nếu hướng d làm thay đổi bàn cờ mới). nextBoards có thể trùng boards.
+//
+// Bàn cờ 4 bit không gộp được hai ô 32768, nên ván có ô 32768 được đi tiếp trên wideBoards[i].
+// escaped[i] vừa vào vừa ra: khởi tạo bằng 0; khi bật thì wideBoards[i] là ván thật (boards[i] bị bỏ qua)
+// và nextBoards[i] chỉ là bản xem với các ô lớn hơn bị chặn ở 32768. Người gọi chỉ cần giữ nguyên
+// escaped và wideBoards giữa các lần gọi, kết quả luôn đúng luật.
+void stepBatch(int count, const Board *boards, const uint8_t *actions, Rng *rngs, Board *nextBoards,
+               int32_t *rewards, uint8_t *done, uint8_t *legalMoves, uint8_t *escaped, WideBoard *wideBoards);
+
+#endif
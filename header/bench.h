@@ -0,0 +1,7 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Chạy benchmark theo tên (gọi từ dòng lệnh: game.exe --bench <tên>), trả về false nếu không có tên này
+bool runBenchmark(const char *name);
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <cstdint>
+
+// Bàn cờ 4x4 nén trong một số 64-bit: mỗi ô 4 bit chứa số mũ log2 của giá trị (0 là ô trống).
+// Ô (i, j) nằm ở nibble thứ i * 4 + j, hàng i chiếm 16 bit từ bit 16 * i.
+typedef uint64_t Board;
+
+const int BOARD_SIZE = 4;
+const int BOARD_CELLS = BOARD_SIZE * BOARD_SIZE;
+const int MAX_EXPONENT = 15; // 32768 là ô lớn nhất vừa 4 bit
+const int WIN_EXPONENT = 11; // 2048
+
+enum Direction
+{
+    DIR_UP,
+    DIR_DOWN,
+    DIR_LEFT,
+    DIR_RIGHT
+};
+
+inline int getTile(Board board, int i, int j)
+{
+    return (board >> (4 * (i * BOARD_SIZE + j))) & 0xF;
+}
+
+inline Board setTile(Board board, int i, int j, int exponent)
+{
+    int shift = 4 * (i * BOARD_SIZE + j);
+    return (board & ~(Board(0xF) << shift)) | (Board(exponent) << shift);
+}
+
+// Giá trị hiển thị của một ô (2, 4, 8, ...) từ số mũ
+inline int tileValue(int exponent)
+{
+    return exponent == 0 ? 0 : 1 << exponent;
+}
+
+// Mỗi ô trống cho 1 bit ở vị trí bit thấp nhất của nibble tương ứng
+inline Board emptyMask(Board board)
+{
+    Board x = board | (board >> 1);
+    x |= x >> 2;
+    return ~x & 0x1111111111111111ULL;
+}
+
+// Gom các bit 4n của một mặt nạ dạng nibble (như emptyMask) thành bit n của số 16 bit
+inline uint32_t compressNibbleMask(Board mask)
+{
+    mask &= 0x1111111111111111ULL;
+    mask = (mask | (mask >> 3)) & 0x0303030303030303ULL;
+    mask = (mask | (mask >> 6)) & 0x000F000F000F000FULL;
+    mask = (mask | (mask >> 12)) & 0x000000FF000000FFULL;
+    return uint32_t((mask | (mask >> 24)) & 0xFFFF);
+}
+
+// Chuyển vị bàn cờ: ô (i, j) đổi chỗ với ô (j, i)
+inline Board transposeBoard(Board board)
+{
+    Board a1 = board & 0xF0F00F0FF0F00F0FULL;
+    Board a2 = board & 0x0000F0F00000F0F0ULL;
+    Board a3 = board & 0x0F0F00000F0F0000ULL;
+    Board a = a1 | (a2 << 12) | (a3 >> 12);
+    Board b1 = a & 0xFF00FF0000FF00FFULL;
+    Board b2 = a & 0x00FF00FF00000000ULL;
+    Board b3 = a & 0x00000000FF00FF00ULL;
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+// Trượt và gộp một hàng LENGTH ô về phía chỉ số 0 theo luật của moveTiles:
+// mỗi ô trượt tới khi gặp ô khác, gộp nếu bằng nhau (ô vừa gộp vẫn có thể gộp tiếp).
+// Hai ô số mũ MAXIMUM không gộp được vì kết quả không vừa ô.
+// to[k] nhận vị trí mới của ô k; trả về true nếu có ô thay đổi.
+template <int LENGTH, int MAXIMUM = MAX_EXPONENT>
+bool slideLine(int line[LENGTH], int to[LENGTH], int &scoreGain)
+{
+    bool moved = false;
+    for (int k = 0; k < LENGTH; ++k)
+    {
+        to[k] = k;
+    }
+
+    for (int k = 1; k < LENGTH; ++k)
+    {
+        if (line[k] == 0)
+        {
+            continue;
+        }
+        int x = k - 1;
+        while (x >= 0 && line[x] == 0)
+        {
+            --x;
+        }
+        if (x >= 0 && line[x] == line[k] && line[x] < MAXIMUM)
+        {
+            line[x]++;
+            scoreGain += tileValue(line[x]);
+            line[k] = 0;
+            to[k] = x;
+            moved = true;
+        }
+        else
+        {
+            ++x;
+            if (x != k)
+            {
+                line[x] = line[k];
+                line[k] = 0;
+                to[k] = x;
+                moved = true;
+            }
+        }
+    }
+    return moved;
+}
+
+const int MAX_TRAJECTORIES = 64; // đủ cho bàn 8x8
+
+// Đường đi của một ô trong một nước: from -> to là chỉ số ô, merged nếu ô đích nhận một lần gộp
+struct Trajectory
+{
+    uint8_t from;
+    uint8_t to;
+    uint8_t merged;
+};
+
+// Kết quả một nước đi, đặt trên stack nên không cấp phát gì
+struct MoveResult
+{
+    bool moved;
+    int scoreGain;
+    uint64_t mergeMask; // bit n bật nếu ô n nhận một lần gộp
+    int count;          // số ô đã di chuyển
+    Trajectory trajectories[MAX_TRAJECTORIES];
+
+    void reset()
+    {
+        moved = false;
+        scoreGain = 0;
+        mergeMask = 0;
+        count = 0;
+    }
+
+    void add(int from, int to)
+    {
+        Trajectory &t = trajectories[count++];
+        t.from = from;
+        t.to = to;
+        t.merged = 0;
+    }
+
+    // Gọi sau khi mergeMask đã đủ
+    void markMerges()
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            trajectories[i].merged = (mergeMask >> trajectories[i].to) & 1;
+        }
+    }
+};
+
+// Các vị trí trên một hàng nhận từ hai ô trở lên sau slideLine, tức là đã gộp
+template <int LENGTH>
+int lineMerges(const int before[LENGTH], const int to[LENGTH])
+{
+    int arrivals[LENGTH] = {};
+    int merges = 0;
+    for (int k = 0; k < LENGTH; ++k)
+    {
+        if (before[k] != 0 && ++arrivals[to[k]] == 2)
+        {
+            merges |= 1 << to[k];
+        }
+    }
+    return merges;
+}
+
+// Di chuyển bàn cờ theo một hướng, trả về true nếu có ô thay đổi.
+// scoreGain nhận tổng điểm các lần gộp; result (nếu có) nhận đầy đủ đường đi của các ô và các ô được gộp.
+bool moveBoard(Board &board, Direction dir, int &scoreGain, MoveResult *result = nullptr);
+
+// Kiểm tra còn ô trống hoặc cặp ô kề nhau bằng nhau
+bool canMoveBoard(Board board);
+
+// Mặt nạ 4 bit các hướng đi hợp lệ (bit d ứng với Direction d), tính thẳng từ các hàng/cột không cần đi thử
+int legalMoves(Board board);
+
+// Số mũ lớn nhất trên bàn cờ
+int maxTile(Board board);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef CHANCE_H
+#define CHANCE_H
+
+#include "spawn.h"
+
+// Một kết quả sinh ô sau nước đi: bàn cờ mới, ô và số mũ được sinh, xác suất của kết quả
+struct ChanceOutcome
+{
+    Board board;
+    int cell;
+    int exponent;
+    float probability;
+};
+
+// Duyệt mọi kết quả sinh ô của một afterstate (bàn cờ ngay sau nước đi, trước khi sinh ô):
+// mỗi ô trống x mỗi loại ô của POLICY. Chạy thẳng trên emptyMask, không cấp phát gì.
+//     for (ChanceOutcome outcome : ChanceOutcomes<>(afterstate)) ...
+template <typename POLICY = ClassicSpawn>
+class ChanceOutcomes
+{
+public:
+    class Iterator
+    {
+    public:
+        Iterator(Board board, Board remaining, float cellProbability)
+            : board_(board), remaining_(remaining), kind_(0), cellProbability_(cellProbability)
+        {
+        }
+
+        ChanceOutcome operator*() const
+        {
+            int shift = __builtin_ctzll(remaining_); // bit thấp của nibble ô trống
+            ChanceOutcome outcome;
+            outcome.board = board_ | (Board(POLICY::exponent(kind_)) << shift);
+            outcome.cell = shift / 4;
+            outcome.exponent = POLICY::exponent(kind_);
+            outcome.probability = cellProbability_ * POLICY::weight(kind_) / POLICY::TOTAL;
+            return outcome;
+        }
+
+        Iterator &operator++()
+        {
+            if (++kind_ == POLICY::KINDS)
+            {
+                kind_ = 0;
+                remaining_ &= remaining_ - 1;
+            }
+            return *this;
+        }
+
+        bool operator!=(const Iterator &other) const
+        {
+            return remaining_ != other.remaining_ || kind_ != other.kind_;
+        }
+
+    private:
+        Board board_;
+        Board remaining_;
+        int kind_;
+        float cellProbability_;
+    };
+
+    explicit ChanceOutcomes(Board afterstate)
+        : board_(afterstate), empty_(emptyMask(afterstate))
+    {
+    }
+
+    // Chỉ duyệt các ô trong cells (mặt nạ dạng emptyMask, là tập con các ô trống),
+    // xác suất chia đều trên các ô đó
+    ChanceOutcomes(Board afterstate, Board cells)
+        : board_(afterstate), empty_(cells)
+    {
+    }
+
+    // Số ô được duyệt; số kết quả là emptyCount() * POLICY::KINDS
+    int emptyCount() const { return __builtin_popcountll(empty_); }
+    int size() const { return emptyCount() * POLICY::KINDS; }
+
+    Iterator begin() const
+    {
+        int count = emptyCount();
+        return Iterator(board_, empty_, count ? 1.0f / count : 0.0f);
+    }
+
+    Iterator end() const { return Iterator(board_, 0, 0.0f); }
+
+private:
+    Board board_;
+    Board empty_;
+};
+
+#endif
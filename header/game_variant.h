@@ -0,0 +1,200 @@
+#ifndef GAME_VARIANT_H
+#define GAME_VARIANT_H
+
+#include "grid_engine.h"
+
+// Một ván chơi với kích thước chọn lúc chạy; mỗi kích thước là một bản GridEngine riêng
+class GameVariant
+{
+public:
+    virtual ~GameVariant() {}
+    virtual int rows() const = 0;
+    virtual int cols() const = 0;
+    virtual void clear() = 0;
+    virtual int getTile(int i, int j) const = 0;
+    // result (nếu có) nhận đường đi của các ô để vẽ hoạt ảnh
+    virtual bool move(Direction dir, int &scoreGain, MoveResult *result = nullptr) = 0;
+    virtual bool canMove() const = 0;
+    virtual int maxTile() const = 0;
+    virtual int emptyCount() const = 0;
+    // Sinh ô mới bằng rng, trả về false nếu hết ô trống
+    virtual bool spawn(Rng &rng) = 0;
+    // Trạng thái cập nhật dần: còn nước đi / đã thắng trong O(1)
+    virtual bool hasMove() const = 0;
+    // Bit d bật nếu đi hướng d làm thay đổi bàn cờ
+    virtual int legalMoves() const = 0;
+    virtual bool won() const = 0;
+    // So trạng thái cập nhật dần với một lần quét toàn bộ, trả về false nếu lệch
+    virtual bool checkStatus() const = 0;
+    // Bàn cờ nén thành packedWords(packedWide()) word 64 bit, dùng cho lịch sử undo/redo.
+    // wide là bố cục 8 bit sau khi ván vượt ô 32768; bản ghi lưu ở bố cục nào thì nạp lại đúng bố cục đó
+    virtual int packedWords(bool wide) const = 0;
+    virtual bool packedWide() const = 0;
+    virtual void savePacked(uint64_t *words) const = 0;
+    virtual void loadPacked(const uint64_t *words, bool wide) = 0;
+};
+
+template <int ROWS, int COLS, int BITS = 4>
+class GridVariant : public GameVariant
+{
+public:
+    typedef GridEngine<ROWS, COLS, BITS> Engine;
+
+    GridVariant()
+    {
+        clear();
+    }
+
+    int rows() const { return ROWS; }
+    int cols() const { return COLS; }
+    int getTile(int i, int j) const { return Engine::getTile(grid, i, j); }
+    bool canMove() const { return Engine::canMove(grid); }
+    int maxTile() const { return status.maxTile; }
+    int emptyCount() const { return __builtin_popcountll(status.empty); }
+    bool spawn(Rng &rng) { return Engine::spawn(grid, rng, &status); }
+    bool hasMove() const { return status.hasMove(); }
+    int legalMoves() const { return statusLegalMoves<ROWS, COLS>(status); }
+    bool won() const { return status.won(); }
+
+    void clear()
+    {
+        Engine::clear(grid);
+        Engine::scanStatus(grid, status);
+    }
+
+    int packedWords(bool) const { return Engine::WORDS; }
+    bool packedWide() const { return false; }
+    void savePacked(uint64_t *words) const { Engine::save(grid, words); }
+
+    void loadPacked(const uint64_t *words, bool)
+    {
+        Engine::load(grid, words);
+        Engine::scanStatus(grid, status);
+    }
+
+    bool checkStatus() const
+    {
+        GridStatus scanned;
+        Engine::scanStatus(grid, scanned);
+        return scanned == status && scanned.hasMove() == Engine::canMove(grid);
+    }
+
+    bool move(Direction dir, int &scoreGain, MoveResult *result)
+    {
+        switch (dir)
+        {
+        case DIR_UP:
+            return Engine::template move<DIR_UP>(grid, scoreGain, result, &status);
+        case DIR_DOWN:
+            return Engine::template move<DIR_DOWN>(grid, scoreGain, result, &status);
+        case DIR_LEFT:
+            return Engine::template move<DIR_LEFT>(grid, scoreGain, result, &status);
+        default:
+            return Engine::template move<DIR_RIGHT>(grid, scoreGain, result, &status);
+        }
+    }
+
+    typename Engine::Grid grid;
+    GridStatus status;
+};
+
+// Ván dùng bố cục 4 bit (kernel nhanh, 4x4 dùng bảng tra) cho tới khi xuất hiện ô 32768,
+// rồi chuyển hẳn sang bố cục 8 bit để các ô 65536 trở lên gộp được như luật gốc.
+// Một nước đi chỉ tăng ô lớn nhất thêm tối đa 1, nên chuyển ngay khi có ô 32768 là đủ:
+// trên bố cục 4 bit chưa bao giờ có hai ô 32768 cần gộp.
+template <int ROWS, int COLS>
+class EscapeVariant : public GameVariant
+{
+public:
+    typedef GridVariant<ROWS, COLS> Narrow;
+    typedef GridVariant<ROWS, COLS, WIDE_CELL_BITS> Wide;
+
+    EscapeVariant() : wideMode(false) {}
+
+    int rows() const { return ROWS; }
+    int cols() const { return COLS; }
+    int getTile(int i, int j) const { return wideMode ? wide.getTile(i, j) : narrow.getTile(i, j); }
+    bool canMove() const { return wideMode ? wide.canMove() : narrow.canMove(); }
+    int maxTile() const { return wideMode ? wide.maxTile() : narrow.maxTile(); }
+    int emptyCount() const { return wideMode ? wide.emptyCount() : narrow.emptyCount(); }
+    bool hasMove() const { return wideMode ? wide.hasMove() : narrow.hasMove(); }
+    int legalMoves() const { return wideMode ? wide.legalMoves() : narrow.legalMoves(); }
+    bool won() const { return wideMode ? wide.won() : narrow.won(); }
+    bool checkStatus() const { return wideMode ? wide.checkStatus() : narrow.checkStatus(); }
+    bool isWide() const { return wideMode; }
+
+    void clear()
+    {
+        wideMode = false;
+        narrow.clear();
+    }
+
+    bool move(Direction dir, int &scoreGain, MoveResult *result)
+    {
+        if (wideMode)
+        {
+            return wide.move(dir, scoreGain, result);
+        }
+        bool moved = narrow.move(dir, scoreGain, result);
+        if (narrow.status.maxTile == MAX_EXPONENT)
+        {
+            widen();
+        }
+        return moved;
+    }
+
+    bool spawn(Rng &rng)
+    {
+        return wideMode ? wide.spawn(rng) : narrow.spawn(rng);
+    }
+
+    // Bản ghi theo bố cục của chế độ hiện tại: bố cục 4 bit cho tới khi chuyển, bố cục 8 bit sau đó.
+    // Ô không bao giờ nhỏ đi nên mọi bản ghi 8 bit đều có ô 32768 và nạp lại ở chế độ rộng.
+    int packedWords(bool wideLayout) const { return wideLayout ? Wide::Engine::WORDS : Narrow::Engine::WORDS; }
+    bool packedWide() const { return wideMode; }
+
+    void savePacked(uint64_t *words) const
+    {
+        if (wideMode)
+        {
+            wide.savePacked(words);
+        }
+        else
+        {
+            narrow.savePacked(words);
+        }
+    }
+
+    void loadPacked(const uint64_t *words, bool wideLayout)
+    {
+        wideMode = wideLayout;
+        if (wideMode)
+        {
+            wide.loadPacked(words, true);
+        }
+        else
+        {
+            narrow.loadPacked(words, false);
+        }
+    }
+
+private:
+    void widen()
+    {
+        convertGrid<typename Narrow::Engine, typename Wide::Engine>(narrow.grid, wide.grid, ROWS, COLS);
+        Wide::Engine::scanStatus(wide.grid, wide.status);
+        wideMode = true;
+    }
+
+    Narrow narrow;
+    Wide wide;
+    bool wideMode;
+};
+
+const int MIN_GRID_SIZE = 3;
+const int MAX_GRID_SIZE = 8;
+
+// Tạo ván size x size, trả về nullptr nếu kích thước không hỗ trợ
+GameVariant *createGameVariant(int size);
+
+#endif
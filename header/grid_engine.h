@@ -0,0 +1,442 @@
+#ifndef GRID_ENGINE_H
+#define GRID_ENGINE_H
+
+#include "board.h"
+#include "move_table.h"
+#include "spawn.h"
+
+// Luật chơi cho bàn cờ ROWS x COLS (2..8), kích thước và hướng đi là tham số template
+// để trình biên dịch trải hết vòng lặp cho từng biến thể.
+
+// Bàn cờ nén tổng quát: mỗi ô BITS bit, ô thứ n = i * COLS + j nằm ở word n / (64 / BITS).
+// Với ô 4 bit, 3x3 vừa một uint64_t, 5x5 dùng 128 bit, 6x6 tới 8x8 dùng 3-4 word.
+// Ô 8 bit là bố cục rộng cho ván có ô từ 65536 trở lên.
+template <int ROWS, int COLS, int BITS = 4>
+struct PackedGrid
+{
+    static const int CELLS = ROWS * COLS;
+    static const int CELLS_PER_WORD = 64 / BITS;
+    static const int WORDS = (CELLS + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    uint64_t words[WORDS];
+};
+
+const int WIDE_CELL_BITS = 8;
+
+// Trạng thái được cập nhật dần sau mỗi nước đi và mỗi ô mới, để hỏi còn nước đi / đã thắng trong O(1).
+// Bit n ứng với ô n = i * COLS + j.
+struct GridStatus
+{
+    uint64_t empty;       // ô n trống
+    uint64_t rowPairs;    // ô n gộp được với ô bên phải
+    uint64_t columnPairs; // ô n gộp được với ô bên dưới
+    int maxTile;
+
+    bool hasMove() const
+    {
+        return (empty | rowPairs | columnPairs) != 0;
+    }
+
+    bool won() const
+    {
+        return maxTile >= WIN_EXPONENT;
+    }
+
+    bool operator==(const GridStatus &other) const
+    {
+        return empty == other.empty && rowPairs == other.rowPairs && columnPairs == other.columnPairs && maxTile == other.maxTile;
+    }
+};
+
+// Mặt nạ các hướng đi hợp lệ (bit d ứng với Direction d) tính trong O(1) từ status của bàn ROWS x COLS
+template <int ROWS, int COLS>
+int statusLegalMoves(const GridStatus &status)
+{
+    const int CELLS = ROWS * COLS;
+    const uint64_t all = CELLS == 64 ? ~uint64_t(0) : (uint64_t(1) << CELLS) - 1;
+    uint64_t lastCol = 0;
+    for (int i = 0; i < ROWS; ++i)
+    {
+        lastCol |= uint64_t(1) << (i * COLS + COLS - 1);
+    }
+    const uint64_t notLastCol = all & ~lastCol;
+    const uint64_t notLastRow = all >> COLS;
+
+    uint64_t empty = status.empty;
+    uint64_t tiles = ~empty & all;
+    int mask = 0;
+    mask |= ((empty & (tiles >> COLS) & notLastRow) | status.columnPairs) ? 1 << DIR_UP : 0;
+    mask |= ((tiles & (empty >> COLS) & notLastRow) | status.columnPairs) ? 1 << DIR_DOWN : 0;
+    mask |= ((empty & (tiles >> 1) & notLastCol) | status.rowPairs) ? 1 << DIR_LEFT : 0;
+    mask |= ((tiles & (empty >> 1) & notLastCol) | status.rowPairs) ? 1 << DIR_RIGHT : 0;
+    return mask;
+}
+
+template <int ROWS, int COLS, int BITS = 4>
+struct GridEngine
+{
+    static_assert(ROWS >= 2 && ROWS <= 8 && COLS >= 2 && COLS <= 8, "Grid size must be between 2 and 8");
+    static_assert(BITS == 4 || BITS == 8, "Cells are 4 or 8 bits wide");
+
+    typedef PackedGrid<ROWS, COLS, BITS> Grid;
+    static const int CELLS = ROWS * COLS;
+    static const int WORDS = Grid::WORDS;
+    static const int MAXIMUM = (1 << BITS) - 1; // số mũ lớn nhất vừa một ô
+
+    static void clear(Grid &grid)
+    {
+        for (int w = 0; w < WORDS; ++w)
+        {
+            grid.words[w] = 0;
+        }
+    }
+
+    static void save(const Grid &grid, uint64_t *words)
+    {
+        for (int w = 0; w < WORDS; ++w)
+        {
+            words[w] = grid.words[w];
+        }
+    }
+
+    static void load(Grid &grid, const uint64_t *words)
+    {
+        for (int w = 0; w < WORDS; ++w)
+        {
+            grid.words[w] = words[w];
+        }
+    }
+
+    static int getTile(const Grid &grid, int i, int j)
+    {
+        int n = i * COLS + j;
+        return (grid.words[n / Grid::CELLS_PER_WORD] >> (BITS * (n % Grid::CELLS_PER_WORD))) & MAXIMUM;
+    }
+
+    static void setTile(Grid &grid, int i, int j, int exponent)
+    {
+        int n = i * COLS + j;
+        uint64_t &word = grid.words[n / Grid::CELLS_PER_WORD];
+        int shift = BITS * (n % Grid::CELLS_PER_WORD);
+        word = (word & ~(uint64_t(MAXIMUM) << shift)) | (uint64_t(exponent) << shift);
+    }
+
+    // Chỉ số ô thứ k trên đường thứ l, đường được đọc theo chiều di chuyển
+    template <Direction DIR>
+    static int lineCell(int l, int k)
+    {
+        switch (DIR)
+        {
+        case DIR_UP:
+            return k * COLS + l;
+        case DIR_DOWN:
+            return (ROWS - 1 - k) * COLS + l;
+        case DIR_LEFT:
+            return l * COLS + k;
+        default:
+            return l * COLS + (COLS - 1 - k);
+        }
+    }
+
+    static bool mergeable(int a, int b)
+    {
+        return a != 0 && a == b && a < MAXIMUM;
+    }
+
+    // Tính lại các bit của ô n trong status: ô trống, cặp với ô phải/dưới, và cặp của ô trái/trên với nó
+    static void updateStatusCell(const Grid &grid, GridStatus &status, int n)
+    {
+        int i = n / COLS, j = n % COLS;
+        int exponent = getTile(grid, i, j);
+        uint64_t bit = uint64_t(1) << n;
+
+        status.empty = exponent == 0 ? status.empty | bit : status.empty & ~bit;
+        status.maxTile = exponent > status.maxTile ? exponent : status.maxTile;
+
+        bool right = j < COLS - 1 && mergeable(exponent, getTile(grid, i, j + 1));
+        bool down = i < ROWS - 1 && mergeable(exponent, getTile(grid, i + 1, j));
+        status.rowPairs = right ? status.rowPairs | bit : status.rowPairs & ~bit;
+        status.columnPairs = down ? status.columnPairs | bit : status.columnPairs & ~bit;
+        if (j > 0)
+        {
+            uint64_t left = bit >> 1;
+            status.rowPairs = mergeable(getTile(grid, i, j - 1), exponent) ? status.rowPairs | left : status.rowPairs & ~left;
+        }
+        if (i > 0)
+        {
+            uint64_t up = bit >> COLS;
+            status.columnPairs = mergeable(getTile(grid, i - 1, j), exponent) ? status.columnPairs | up : status.columnPairs & ~up;
+        }
+    }
+
+    // Quét toàn bộ bàn cờ, dùng khi bắt đầu ván và để tự kiểm tra
+    static void scanStatus(const Grid &grid, GridStatus &status)
+    {
+        status.empty = status.rowPairs = status.columnPairs = 0;
+        status.maxTile = 0;
+        for (int n = 0; n < CELLS; ++n)
+        {
+            updateStatusCell(grid, status, n);
+        }
+    }
+
+    // Giống moveBoard: result (nếu có) nhận đường đi và các ô được gộp.
+    // status (nếu có) chỉ được cập nhật ở các đường thay đổi
+    template <Direction DIR>
+    static bool move(Grid &grid, int &scoreGain, MoveResult *result = nullptr, GridStatus *status = nullptr)
+    {
+        const bool vertical = DIR == DIR_UP || DIR == DIR_DOWN;
+        const int LINES = vertical ? COLS : ROWS;
+        const int LENGTH = vertical ? ROWS : COLS;
+        bool moved = false;
+        scoreGain = 0;
+
+        if (result)
+        {
+            result->reset();
+        }
+
+        for (int l = 0; l < LINES; ++l)
+        {
+            int before[LENGTH];
+            int line[LENGTH];
+            int to[LENGTH];
+            for (int k = 0; k < LENGTH; ++k)
+            {
+                int n = lineCell<DIR>(l, k);
+                line[k] = before[k] = getTile(grid, n / COLS, n % COLS);
+            }
+
+            if (!slideLine<LENGTH, MAXIMUM>(line, to, scoreGain))
+            {
+                continue;
+            }
+            moved = true;
+
+            int merges = result ? lineMerges<LENGTH>(before, to) : 0;
+            for (int k = 0; k < LENGTH; ++k)
+            {
+                int n = lineCell<DIR>(l, k);
+                setTile(grid, n / COLS, n % COLS, line[k]);
+                if (result)
+                {
+                    if (to[k] != k)
+                    {
+                        result->add(n, lineCell<DIR>(l, to[k]));
+                    }
+                    result->mergeMask |= uint64_t((merges >> k) & 1) << n;
+                }
+            }
+            if (status)
+            {
+                for (int k = 0; k < LENGTH; ++k)
+                {
+                    updateStatusCell(grid, *status, lineCell<DIR>(l, k));
+                }
+            }
+        }
+
+        if (result)
+        {
+            result->moved = moved;
+            result->scoreGain = scoreGain;
+            result->markMerges();
+        }
+        return moved;
+    }
+
+    static bool canMove(const Grid &grid)
+    {
+        for (int i = 0; i < ROWS; ++i)
+        {
+            for (int j = 0; j < COLS; ++j)
+            {
+                int exponent = getTile(grid, i, j);
+                if (exponent == 0)
+                {
+                    return true;
+                }
+                if (i < ROWS - 1 && exponent == getTile(grid, i + 1, j) && exponent < MAXIMUM)
+                {
+                    return true;
+                }
+                if (j < COLS - 1 && exponent == getTile(grid, i, j + 1) && exponent < MAXIMUM)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static int maxTile(const Grid &grid)
+    {
+        int best = 0;
+        for (int n = 0; n < CELLS; ++n)
+        {
+            int exponent = getTile(grid, n / COLS, n % COLS);
+            best = exponent > best ? exponent : best;
+        }
+        return best;
+    }
+
+    static int emptyCount(const Grid &grid)
+    {
+        int count = 0;
+        for (int n = 0; n < CELLS; ++n)
+        {
+            count += getTile(grid, n / COLS, n % COLS) == 0;
+        }
+        return count;
+    }
+
+    // Mặt nạ ô trống, bit n = ô n
+    static uint64_t emptyCells(const Grid &grid)
+    {
+        uint64_t empty = 0;
+        for (int n = 0; n < CELLS; ++n)
+        {
+            empty |= uint64_t(getTile(grid, n / COLS, n % COLS) == 0) << n;
+        }
+        return empty;
+    }
+
+    // Sinh ô mới bằng rng; nếu có status thì lấy luôn mặt nạ ô trống từ đó
+    static bool spawn(Grid &grid, Rng &rng, GridStatus *status = nullptr)
+    {
+        int n, exponent;
+        if (!chooseSpawn(status ? status->empty : emptyCells(grid), rng, n, exponent))
+        {
+            return false;
+        }
+        setTile(grid, n / COLS, n % COLS, exponent);
+        if (status)
+        {
+            updateStatusCell(grid, *status, n);
+        }
+        return true;
+    }
+};
+
+// 4x4 dùng bàn cờ 64 bit và kernel bảng tra
+template <>
+struct GridEngine<4, 4, 4>
+{
+    typedef Board Grid;
+    static const int CELLS = BOARD_CELLS;
+    static const int WORDS = 1;
+    static const int MAXIMUM = MAX_EXPONENT;
+
+    static void clear(Grid &grid)
+    {
+        grid = 0;
+    }
+
+    static void save(const Grid &grid, uint64_t *words)
+    {
+        words[0] = grid;
+    }
+
+    static void load(Grid &grid, const uint64_t *words)
+    {
+        grid = words[0];
+    }
+
+    static int getTile(const Grid &grid, int i, int j)
+    {
+        return ::getTile(grid, i, j);
+    }
+
+    static void setTile(Grid &grid, int i, int j, int exponent)
+    {
+        grid = ::setTile(grid, i, j, exponent);
+    }
+
+    // Với bàn cờ 64 bit, ô trống và các cặp gộp được tính cho cả bàn bằng vài phép bit,
+    // nên cập nhật sau mỗi nước đi cũng là O(1)
+    static void scanPairs(const Grid &grid, GridStatus &status)
+    {
+        Board mergeable = ~emptyMask(grid) & ~emptyMask(~grid);
+        status.empty = compressNibbleMask(emptyMask(grid));
+        status.rowPairs = compressNibbleMask(emptyMask(grid ^ (grid >> 4)) & mergeable & 0x0111011101110111ULL);
+        status.columnPairs = compressNibbleMask(emptyMask(grid ^ (grid >> 16)) & mergeable & 0x0000111111111111ULL);
+    }
+
+    static void scanStatus(const Grid &grid, GridStatus &status)
+    {
+        scanPairs(grid, status);
+        status.maxTile = ::maxTile(grid);
+    }
+
+    // Ô lớn nhất chỉ tăng khi gộp nên chỉ cần kiểm tra các giá trị lớn hơn nó
+    static void raiseMaxTile(const Grid &grid, GridStatus &status)
+    {
+        while (status.maxTile < MAX_EXPONENT && emptyMask(grid ^ (Board(status.maxTile + 1) * 0x1111111111111111ULL)))
+        {
+            status.maxTile++;
+        }
+    }
+
+    template <Direction DIR>
+    static bool move(Grid &grid, int &scoreGain, MoveResult *result = nullptr, GridStatus *status = nullptr)
+    {
+        bool moved = moveBoardTable(grid, DIR, scoreGain, result);
+        if (moved && status)
+        {
+            scanPairs(grid, *status);
+            raiseMaxTile(grid, *status);
+        }
+        return moved;
+    }
+
+    static bool canMove(const Grid &grid)
+    {
+        return canMoveBoard(grid);
+    }
+
+    static int maxTile(const Grid &grid)
+    {
+        return ::maxTile(grid);
+    }
+
+    static int emptyCount(const Grid &grid)
+    {
+        return __builtin_popcountll(emptyMask(grid));
+    }
+
+    static uint64_t emptyCells(const Grid &grid)
+    {
+        return compressNibbleMask(emptyMask(grid));
+    }
+
+    static bool spawn(Grid &grid, Rng &rng, GridStatus *status = nullptr)
+    {
+        Board before = grid;
+        if (!spawnTile(grid, rng))
+        {
+            return false;
+        }
+        if (status)
+        {
+            scanPairs(grid, *status);
+            int exponent = maxTile(grid ^ before);
+            status->maxTile = exponent > status->maxTile ? exponent : status->maxTile;
+        }
+        return true;
+    }
+};
+
+// Chép từng ô giữa hai bố cục của cùng một kích thước bàn cờ
+template <typename FROM, typename TO>
+void convertGrid(const typename FROM::Grid &from, typename TO::Grid &to, int rows, int cols)
+{
+    TO::clear(to);
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            TO::setTile(to, i, j, FROM::getTile(from, i, j));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include "move_table.h"
+
+// Trọng số của hàm đánh giá, đọc được từ file để chỉnh mà không cần biên dịch lại
+struct HeuristicWeights
+{
+    float base;              // hằng số cộng cho mỗi hàng/cột, giữ giá trị dương để thua (0) luôn tệ nhất
+    float empty;             // mỗi ô trống
+    float merges;            // mỗi ô nằm trong một dãy ô bằng nhau liền nhau
+    float monotonicity;      // phạt hàng không tăng/giảm đều
+    float monotonicityPower; // số mũ nâng lên trước khi so độ đơn điệu
+    float sum;               // phạt tổng các ô
+    float sumPower;
+
+    HeuristicWeights()
+        : base(200000), empty(270), merges(700), monotonicity(47), monotonicityPower(4), sum(11), sumPower(3.5f)
+    {
+    }
+};
+
+// Đọc file dạng "tên giá trị" mỗi dòng (dòng bắt đầu bằng # là chú thích); tên là tên trường ở trên.
+// Trả về false nếu không mở được file hoặc gặp tên lạ.
+bool loadHeuristicWeights(const char *path, HeuristicWeights &weights);
+
+// Đánh giá một hàng 4 ô (16 bit) theo từng ô, dùng để dựng bảng
+float evaluateLine(uint16_t row, const HeuristicWeights &weights);
+
+// Bảng đánh giá cho mọi hàng: giá trị bàn cờ là tổng 4 hàng và 4 cột, tức 8 lần tra bảng
+struct HeuristicTables
+{
+    float line[ROW_COUNT];
+
+    void build(const HeuristicWeights &weights);
+
+    float evaluate(Board board) const
+    {
+        Board transposed = transposeBoard(board);
+        return line[board & 0xFFFF] + line[(board >> 16) & 0xFFFF] + line[(board >> 32) & 0xFFFF] + line[board >> 48] +
+               line[transposed & 0xFFFF] + line[(transposed >> 16) & 0xFFFF] + line[(transposed >> 32) & 0xFFFF] +
+               line[transposed >> 48];
+    }
+};
+
+// Bảng dùng chung cho AI, dựng với trọng số mặc định ở lần gọi đầu (an toàn khi nhiều luồng cùng gọi)
+const HeuristicTables &heuristicTables();
+
+// Đổi trọng số và dựng lại bảng dùng chung; không gọi khi đang tìm kiếm
+void setHeuristicWeights(const HeuristicWeights &weights);
+
+const HeuristicWeights &heuristicWeights();
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "rng.h"
+#include <vector>
+
+// Lịch sử undo/redo dạng vòng với dung lượng cố định, cấp phát một lần lúc khởi tạo.
+// Mỗi bản ghi chỉ gồm bàn cờ nén và điểm (12 byte với bàn 4x4): số nước đi suy ra từ vị trí
+// trong vòng, còn trạng thái Rng được lưu theo mốc mỗi CHECKPOINT_INTERVAL nước rồi rút tiếp,
+// vì mỗi nước đi hợp lệ rút đúng một số để sinh ô mới.
+// Bản ghi sau khi ván chuyển sang ô 8 bit (wide) nằm trong vòng thứ hai wideWords word mỗi bản ghi,
+// chỉ cấp phát ở lần ghi wide đầu tiên; bit cao của điểm cho biết bản ghi thuộc vòng nào.
+class History
+{
+public:
+    static const int CHECKPOINT_INTERVAL = 64;
+
+    History(int capacity, int boardWords, int wideWords);
+
+    // Bắt đầu ván mới: bản ghi của nước 0 cùng trạng thái rng lúc đó
+    void reset(const uint64_t *board, bool wide, int score, const Rng &rng);
+
+    // Ghi trạng thái sau một nước đi; các bước redo phía sau bị bỏ
+    void push(const uint64_t *board, bool wide, int score, const Rng &rng);
+
+    // Trả về false nếu không còn gì để lùi/tiến; nếu được thì ghi lại toàn bộ trạng thái,
+    // wide cho biết board đang ở bố cục nào
+    bool undo(uint64_t *board, bool &wide, int &score, int &moveCount, Rng &rng);
+    bool redo(uint64_t *board, bool &wide, int &score, int &moveCount, Rng &rng);
+
+    int capacity() const { return capacity_; }
+
+private:
+    static const uint32_t WIDE_RECORD = 0x80000000u; // điểm luôn nhỏ hơn 2^31
+
+    void restore(long long move, uint64_t *board, bool &wide, int &score, int &moveCount, Rng &rng) const;
+    long long oldest() const;
+
+    int capacity_;
+    int boardWords_;
+    int wideWords_;
+    std::vector<uint64_t> boards_;
+    std::vector<uint64_t> wideBoards_;
+    std::vector<uint32_t> scores_;
+    std::vector<Rng> checkpoints_;
+    long long current_; // số nước đi của trạng thái đang hiển thị
+    long long newest_;  // giới hạn redo
+};
+
+#endif
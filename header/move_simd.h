@@ -0,0 +1,31 @@
+#ifndef MOVE_SIMD_H
+#define MOVE_SIMD_H
+
+#include "board.h"
+
+// Kernel di chuyển bằng SIMD, không cần bảng tra: 16 ô được bung ra 16 byte, cả 4 hàng
+// trượt và gộp cùng lúc bằng pshufb/pcmpeqb. Luật giống hệt moveBoard.
+
+typedef bool (*MoveKernel)(Board &board, Direction dir, int &scoreGain);
+
+// true nếu CPU hỗ trợ SSE4.1 (kiểm tra qua SDL_cpuinfo)
+bool simdMoveAvailable();
+
+// Chỉ được gọi khi simdMoveAvailable() trả về true
+bool moveBoardSimd(Board &board, Direction dir, int &scoreGain);
+
+// true nếu CPU hỗ trợ AVX2 để đi 4 bàn cờ cùng lúc
+bool avx2MoveAvailable();
+
+// Đi 4 bàn cờ boards[0..3] theo dirs[0..3], mỗi bàn cờ một lane 64 bit: chuyển vị cả 4 bàn bằng phép dịch
+// 64 bit, rồi 16 hàng tra bảng bằng _mm256_i32gather_epi32. results có thể trùng boards;
+// chỉ được gọi khi avx2MoveAvailable() trả về true
+void moveBoardsAvx2(const Board *boards, const uint8_t *dirs, Board *results, int *scoreGains);
+
+// Chọn kernel lúc chạy: SIMD khi simd bật và CPU có SSE4.1, nếu không thì bảng tra
+MoveKernel selectMoveKernel(bool simd);
+
+// Kernel mặc định: bảng tra, kể cả khi CPU có SSE4.1 (đo trong expectimax, xem move_simd.cpp)
+MoveKernel bestMoveKernel();
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef MOVE_TABLE_H
+#define MOVE_TABLE_H
+
+#include "board.h"
+
+// Bộ máy di chuyển dùng bảng tra: mỗi hàng 16 bit có sẵn kết quả trượt, điểm cộng, vị trí đích
+// và các ô được gộp. Một nước đi chỉ còn 4 lần tra bảng (lên/xuống đi qua phép chuyển vị).
+
+const int ROW_COUNT = 65536;
+
+struct RowTables
+{
+    uint16_t result[ROW_COUNT];
+    uint32_t score[ROW_COUNT];
+    uint8_t targets[ROW_COUNT]; // 2 bit cho mỗi ô nguồn: cột đích
+    uint8_t merges[ROW_COUNT];  // 1 bit cho mỗi cột đích nhận một lần gộp
+
+    // Tính toàn bộ bảng cho hướng trượt về cột 0 (toRight = false) hoặc cột 3.
+    // Cùng luật với slideLine: ô mới gộp vẫn có thể gộp tiếp với ô đến sau nó.
+    constexpr RowTables(bool toRight) : result(), score(), targets(), merges()
+    {
+        for (int row = 0; row < ROW_COUNT; ++row)
+        {
+            int line = 0, to = 0, merged = 0, gain = 0;
+            int top = -1, topExponent = 0;
+            for (int k = 0; k < BOARD_SIZE; ++k)
+            {
+                int col = toRight ? BOARD_SIZE - 1 - k : k;
+                int exponent = (row >> (4 * col)) & 0xF;
+                if (exponent == 0)
+                {
+                    to |= col << (2 * col);
+                    continue;
+                }
+                if (top >= 0 && topExponent == exponent && exponent < MAX_EXPONENT)
+                {
+                    topExponent++;
+                    gain += 1 << topExponent;
+                    merged |= 1 << top;
+                }
+                else
+                {
+                    top = toRight ? (top < 0 ? BOARD_SIZE - 1 : top - 1) : top + 1;
+                    topExponent = exponent;
+                }
+                line = (line & ~(0xF << (4 * top))) | (topExponent << (4 * top));
+                to |= top << (2 * col);
+            }
+            result[row] = line;
+            score[row] = gain;
+            targets[row] = to;
+            merges[row] = merged;
+        }
+    }
+};
+
+// Bảng được tính lúc biên dịch, nằm trong .rodata nên các tiến trình dùng chung qua page cache
+extern const RowTables leftRowTables;
+extern const RowTables rightRowTables;
+
+// Giống moveBoard nhưng tra bảng
+bool moveBoardTable(Board &board, Direction dir, int &scoreGain, MoveResult *result = nullptr);
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// Bộ sinh số ngẫu nhiên xoshiro256** với trạng thái riêng cho từng ván, thay cho srand/rand toàn cục.
+// Cùng seed cho cùng một chuỗi số trên mọi nền tảng.
+struct Rng
+{
+    uint64_t s[4];
+};
+
+// splitmix64: trải seed 64 bit ra trạng thái 256 bit
+constexpr uint64_t splitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline Rng makeRng(uint64_t seed)
+{
+    Rng rng;
+    for (int i = 0; i < 4; ++i)
+    {
+        rng.s[i] = splitMix64(seed);
+    }
+    return rng;
+}
+
+inline uint64_t rotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+inline uint64_t randomNext(Rng &rng)
+{
+    uint64_t *s = rng.s;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+// Số nguyên đều trong [0, n) bằng phép nhân thay cho phép chia lấy dư
+inline uint32_t randomBelow(Rng &rng, uint32_t n)
+{
+    return uint32_t(((randomNext(rng) >> 32) * n) >> 32);
+}
+
+// Nhảy trước 2^128 số: tương đương gọi randomNext 2^128 lần
+inline void rngJump(Rng &rng)
+{
+    static const uint64_t JUMP[] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int b = 0; b < 64; ++b)
+        {
+            if (JUMP[i] & (uint64_t(1) << b))
+            {
+                for (int w = 0; w < 4; ++w)
+                {
+                    s[w] ^= rng.s[w];
+                }
+            }
+            randomNext(rng);
+        }
+    }
+    for (int w = 0; w < 4; ++w)
+    {
+        rng.s[w] = s[w];
+    }
+}
+
+// Tách một luồng con không chồng lấn: luồng con bắt đầu ở vị trí hiện tại, rng nhảy sang đoạn 2^128 kế tiếp
+inline Rng splitRng(Rng &rng)
+{
+    Rng child = rng;
+    rngJump(rng);
+    return child;
+}
+
+// Luồng thứ index của một seed, dùng để chia cho N luồng/ván chạy song song
+inline Rng rngStream(uint64_t seed, int index)
+{
+    Rng rng = makeRng(seed);
+    for (int i = 0; i < index; ++i)
+    {
+        rngJump(rng);
+    }
+    return rng;
+}
+
+#endif
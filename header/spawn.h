@@ -0,0 +1,91 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include "board.h"
+#include "rng.h"
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+// Vị trí của bit bật thứ k (đếm từ 0) trong mask
+inline int selectBit(uint64_t mask, int k)
+{
+#ifdef __BMI2__
+    return __builtin_ctzll(_pdep_u64(uint64_t(1) << k, mask));
+#else
+    // Chia đôi theo popcount: 6 bước cho 64 bit thay vì duyệt từng bit
+    int base = 0;
+    for (int width = 32; width >= 1; width /= 2)
+    {
+        uint64_t low = mask & ((uint64_t(1) << width) - 1);
+        int count = __builtin_popcountll(low);
+        if (k >= count)
+        {
+            k -= count;
+            mask >>= width;
+            base += width;
+        }
+        else
+        {
+            mask = low;
+        }
+    }
+    return base;
+#endif
+}
+
+// Luật sinh ô cố định lúc biên dịch: KINDS loại ô, loại k có số mũ exponent(k) và trọng số weight(k) trên TOTAL.
+// Luật gốc của addRandomTile: 2 với xác suất 90%, 4 với 10%.
+struct ClassicSpawn
+{
+    static const int KINDS = 2;
+    static const int TOTAL = 10;
+    static constexpr int exponent(int kind) { return kind + 1; }
+    static constexpr int weight(int kind) { return kind == 0 ? 9 : 1; }
+};
+
+// Biến thể chỉ sinh ô 2
+struct TwosOnlySpawn
+{
+    static const int KINDS = 1;
+    static const int TOTAL = 1;
+    static constexpr int exponent(int) { return 1; }
+    static constexpr int weight(int) { return 1; }
+};
+
+// Ô mới: ô trống chọn đều trong emptyCells (bit n = ô n), số mũ theo luật POLICY.
+// Chỉ rút một số 64 bit từ rng nên cùng seed luôn cho cùng chuỗi ô mới.
+template <typename POLICY = ClassicSpawn>
+inline bool chooseSpawn(uint64_t emptyCells, Rng &rng, int &cell, int &exponent)
+{
+    int count = __builtin_popcountll(emptyCells);
+    if (count == 0)
+    {
+        return false;
+    }
+    uint64_t r = randomNext(rng);
+    cell = selectBit(emptyCells, int(((r >> 32) * uint64_t(count)) >> 32));
+    int roll = int((uint64_t(uint32_t(r)) * POLICY::TOTAL) >> 32);
+    int kind = 0;
+    while (kind + 1 < POLICY::KINDS && roll >= POLICY::weight(kind))
+    {
+        roll -= POLICY::weight(kind++);
+    }
+    exponent = POLICY::exponent(kind);
+    return true;
+}
+
+// Sinh ô mới trên bàn cờ 4x4, trả về false nếu không còn ô trống
+inline bool spawnTile(Board &board, Rng &rng)
+{
+    int cell, exponent;
+    if (!chooseSpawn(compressNibbleMask(emptyMask(board)), rng, cell, exponent))
+    {
+        return false;
+    }
+    board |= Board(exponent) << (4 * cell);
+    return true;
+}
+
+#endif
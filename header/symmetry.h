@@ -0,0 +1,135 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "board.h"
+
+// 8 phép đối xứng của bàn 4x4. Phép số t làm lần lượt: lật trái-phải nếu bit 0,
+// lật trên-dưới nếu bit 1, chuyển vị nếu bit 2. Các bàn cờ đối xứng có cùng giá trị
+// nên bảng nhớ tạm chỉ cần lưu một đại diện.
+const int SYMMETRY_COUNT = 8;
+
+// Đảo thứ tự 4 nibble trong mỗi hàng
+inline Board flipHorizontal(Board board)
+{
+    board = ((board & 0x0F0F0F0F0F0F0F0FULL) << 4) | ((board >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+    return ((board & 0x00FF00FF00FF00FFULL) << 8) | ((board >> 8) & 0x00FF00FF00FF00FFULL);
+}
+
+// Đảo thứ tự 4 hàng
+inline Board flipVertical(Board board)
+{
+    board = (board << 32) | (board >> 32);
+    return ((board & 0x0000FFFF0000FFFFULL) << 16) | ((board >> 16) & 0x0000FFFF0000FFFFULL);
+}
+
+inline Board applySymmetry(Board board, int transform)
+{
+    if (transform & 1)
+    {
+        board = flipHorizontal(board);
+    }
+    if (transform & 2)
+    {
+        board = flipVertical(board);
+    }
+    if (transform & 4)
+    {
+        board = transposeBoard(board);
+    }
+    return board;
+}
+
+// Đưa bàn cờ về ngược lại từ applySymmetry(board, transform)
+inline Board undoSymmetry(Board board, int transform)
+{
+    if (transform & 4)
+    {
+        board = transposeBoard(board);
+    }
+    if (transform & 2)
+    {
+        board = flipVertical(board);
+    }
+    if (transform & 1)
+    {
+        board = flipHorizontal(board);
+    }
+    return board;
+}
+
+// Hướng dir trên bàn gốc thành hướng tương ứng trên bàn đã biến đổi:
+// applySymmetry(move(board, dir)) == move(applySymmetry(board), mapDirection(dir))
+inline Direction mapDirection(Direction dir, int transform)
+{
+    int d = dir;
+    if (transform & 1)
+    {
+        d = d == DIR_LEFT ? DIR_RIGHT : d == DIR_RIGHT ? DIR_LEFT : d;
+    }
+    if (transform & 2)
+    {
+        d = d == DIR_UP ? DIR_DOWN : d == DIR_DOWN ? DIR_UP : d;
+    }
+    if (transform & 4)
+    {
+        d ^= 2; // UP <-> LEFT, DOWN <-> RIGHT
+    }
+    return Direction(d);
+}
+
+// Hướng trên bàn đã biến đổi về lại hướng trên bàn gốc
+inline Direction unmapDirection(Direction dir, int transform)
+{
+    int d = dir;
+    if (transform & 4)
+    {
+        d ^= 2;
+    }
+    if (transform & 2)
+    {
+        d = d == DIR_UP ? DIR_DOWN : d == DIR_DOWN ? DIR_UP : d;
+    }
+    if (transform & 1)
+    {
+        d = d == DIR_LEFT ? DIR_RIGHT : d == DIR_RIGHT ? DIR_LEFT : d;
+    }
+    return Direction(d);
+}
+
+// Đại diện nhỏ nhất trong 8 bàn cờ đối xứng; transform nhận phép đã dùng:
+// canonicalBoard(board, t) == applySymmetry(board, t).
+// Dùng chung kết quả trung gian: 3 phép lật và 4 phép chuyển vị cho cả 8 bàn.
+inline Board canonicalBoard(Board board, int &transform)
+{
+    Board flipped[4];
+    flipped[0] = board;
+    flipped[1] = flipHorizontal(board);
+    flipped[2] = flipVertical(board);
+    flipped[3] = flipVertical(flipped[1]);
+
+    Board best = board;
+    transform = 0;
+    for (int t = 0; t < 4; ++t)
+    {
+        Board transposed = transposeBoard(flipped[t]);
+        if (flipped[t] < best)
+        {
+            best = flipped[t];
+            transform = t;
+        }
+        if (transposed < best)
+        {
+            best = transposed;
+            transform = t | 4;
+        }
+    }
+    return best;
+}
+
+inline Board canonicalBoard(Board board)
+{
+    int transform;
+    return canonicalBoard(board, transform);
+}
+
+#endif
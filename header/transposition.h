@@ -0,0 +1,55 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include "board.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bảng nhớ tạm giá trị các nút chance của expectimax, khóa là chính bàn cờ 64 bit (có thể đã chuẩn hóa
+// đối xứng). Mỗi bucket 4 mục vừa một cache line 64 byte.
+//
+// Bảng dùng chung cho nhiều luồng mà không cần khóa: mỗi mục là hai word nguyên tử, data chứa
+// giá trị/độ sâu/xác suất/lượt và check = key ^ data. Hai luồng ghi cùng lúc có thể để lại một mục
+// lai giữa hai lần ghi; khi đọc, check ^ data không còn bằng key nên mục đó bị bỏ qua chứ không được tin.
+struct TranspositionEntry
+{
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data; // bit 0-31 giá trị float, 32-47 xác suất, 48-55 độ sâu (0 là trống), 56-63 lượt
+};
+
+struct alignas(64) TranspositionBucket
+{
+    static const int ENTRIES = 4;
+    TranspositionEntry entries[ENTRIES];
+};
+
+class TranspositionTable
+{
+public:
+    // Số bucket làm tròn xuống lũy thừa của 2 sao cho vừa megabytes MB (ít nhất 1 bucket)
+    explicit TranspositionTable(size_t megabytes);
+
+    // Bắt đầu lượt tìm kiếm mới: mục của các lượt trước bị thay trước
+    void newSearch();
+    void clear();
+
+    // Tìm giá trị của key đã được tìm ít nhất depth nước, với xác suất tích lũy ít nhất minProbability
+    // (0 khi cây không cắt tỉa theo xác suất)
+    bool probe(Board key, int depth, float minProbability, float &value) const;
+
+    // Ghi kết quả; trong bucket ưu tiên giữ mục sâu hơn và mục của lượt hiện tại
+    void store(Board key, int depth, float probability, float value);
+
+    size_t memoryBytes() const { return bucketCount_ * sizeof(TranspositionBucket); }
+
+private:
+    TranspositionBucket &bucket(Board key) const;
+
+    std::unique_ptr<TranspositionBucket[]> buckets_;
+    size_t bucketCount_;
+    int indexBits_;
+    std::atomic<uint8_t> generation_;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Nhóm task cùng chờ: wait() trả về khi mọi task đã gửi vào nhóm chạy xong
+struct TaskGroup
+{
+    std::atomic<int> pending;
+
+    TaskGroup() : pending(0) {}
+};
+
+// Task không cấp phát: hàm và đối số nằm trên stack của luồng gửi, còn sống tới khi wait() trả về
+struct Task
+{
+    void (*run)(void *arg);
+    void *arg;
+    TaskGroup *group;
+};
+
+// Pool luồng work-stealing: mỗi luồng có một deque riêng, lấy task mới nhất của mình (LIFO, nóng trong cache)
+// và khi hết việc thì lấy task cũ nhất của luồng khác (FIFO, thường là cây con lớn nhất).
+// Nhờ vậy các cây con không đều nhau tự cân bằng giữa các luồng.
+class WorkPool
+{
+public:
+    // threads tính cả luồng gọi wait(), nên pool tạo threads - 1 luồng phụ
+    explicit WorkPool(int threads);
+    ~WorkPool();
+
+    int threads() const { return int(queues_.size()); }
+
+    void submit(TaskGroup &group, void (*run)(void *arg), void *arg);
+
+    // Luồng chờ cũng chạy task (của mình hoặc lấy từ luồng khác) cho tới khi nhóm xong
+    void wait(TaskGroup &group);
+
+private:
+    struct alignas(64) WorkerQueue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    int queueIndex() const;
+    bool runOne(int self);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<int> queued_;
+    std::atomic<bool> stopping_;
+    std::mutex sleepLock_;
+    std::condition_variable wakeUp_;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "board.h"
+#include "grid_engine.h"
+#include "rng.h"
+
+// Băm Zobrist: mỗi cặp (ô, số mũ) có một khóa 64 bit ngẫu nhiên, khóa của bàn cờ là XOR các khóa
+// của ô có số. Nhờ vậy khi một nước đi đổi vài ô hay khi sinh ô mới chỉ cần XOR phần thay đổi.
+const int ZOBRIST_CELLS = 64;                     // đủ cho bàn 8x8
+const int ZOBRIST_EXPONENTS = ZOBRIST_CELLS + 2; // ô lớn nhất bàn 8x8 có thể đạt là 2^65
+
+struct ZobristKeys
+{
+    uint64_t keys[ZOBRIST_CELLS][ZOBRIST_EXPONENTS];
+
+    constexpr ZobristKeys() : keys()
+    {
+        uint64_t state = 0x2048;
+        for (int c = 0; c < ZOBRIST_CELLS; ++c)
+        {
+            keys[c][0] = 0; // ô trống không góp vào khóa
+            for (int e = 1; e < ZOBRIST_EXPONENTS; ++e)
+            {
+                keys[c][e] = splitMix64(state);
+            }
+        }
+    }
+};
+
+constexpr ZobristKeys zobristKeys;
+
+inline uint64_t zobristKey(int cell, int exponent)
+{
+    return zobristKeys.keys[cell][exponent];
+}
+
+// Bit thấp của mỗi ô BITS bit trong word bật nếu ô đó khác 0 (emptyMask đảo lại, cho cả ô 8 bit)
+template <int BITS = 4>
+inline uint64_t occupiedMask(uint64_t word)
+{
+    const uint64_t lowBits = ~uint64_t(0) / ((uint64_t(1) << BITS) - 1); // 0x1111... hoặc 0x0101...
+    for (int s = 1; s < BITS; s <<= 1)
+    {
+        word |= word >> s;
+    }
+    return word & lowBits;
+}
+
+// Cập nhật khóa khi một word ô BITS bit đổi từ before sang after, chỉ tốn công cho các ô khác nhau.
+// cellOffset là chỉ số ô đầu tiên của word (w * PackedGrid::CELLS_PER_WORD), dùng cho bàn nhiều word.
+template <int BITS = 4>
+inline uint64_t updateHash(uint64_t hash, uint64_t before, uint64_t after, int cellOffset = 0)
+{
+    const uint64_t MAXIMUM = (uint64_t(1) << BITS) - 1;
+    uint64_t changed = occupiedMask<BITS>(before ^ after);
+    while (changed)
+    {
+        int shift = __builtin_ctzll(changed);
+        int cell = cellOffset + shift / BITS;
+        hash ^= zobristKey(cell, (before >> shift) & MAXIMUM) ^ zobristKey(cell, (after >> shift) & MAXIMUM);
+        changed &= changed - 1;
+    }
+    return hash;
+}
+
+// Khóa của cả bàn cờ 4x4, chỉ duyệt các ô có số
+inline uint64_t hashBoard(Board board)
+{
+    return updateHash<4>(0, 0, board);
+}
+
+// Khóa của bàn cờ nén nhiều word (PackedGrid) với cells ô BITS bit
+template <int BITS = 4>
+inline uint64_t hashGrid(const uint64_t *words, int cells)
+{
+    const int CELLS_PER_WORD = 64 / BITS;
+    uint64_t hash = 0;
+    for (int w = 0; w * CELLS_PER_WORD < cells; ++w)
+    {
+        hash = updateHash<BITS>(hash, 0, words[w], w * CELLS_PER_WORD);
+    }
+    return hash;
+}
+
+template <int ROWS, int COLS, int BITS>
+inline uint64_t hashGrid(const PackedGrid<ROWS, COLS, BITS> &grid)
+{
+    return hashGrid<BITS>(grid.words, ROWS * COLS);
+}
+
+// GridEngine<4, 4> dùng thẳng Board
+inline uint64_t hashGrid(Board board)
+{
+    return hashBoard(board);
+}
+
+// Cập nhật khóa sau một nước đi (hoặc bất kỳ thay đổi nào) của bàn nhiều word, bỏ qua các word không đổi
+template <int ROWS, int COLS, int BITS>
+inline uint64_t updateGridHash(uint64_t hash, const PackedGrid<ROWS, COLS, BITS> &before,
+                               const PackedGrid<ROWS, COLS, BITS> &after)
+{
+    typedef PackedGrid<ROWS, COLS, BITS> Grid;
+    for (int w = 0; w < Grid::WORDS; ++w)
+    {
+        if (before.words[w] != after.words[w])
+        {
+            hash = updateHash<BITS>(hash, before.words[w], after.words[w], w * Grid::CELLS_PER_WORD);
+        }
+    }
+    return hash;
+}
+
+inline uint64_t updateGridHash(uint64_t hash, Board before, Board after)
+{
+    return updateHash<4>(hash, before, after);
+}
+
+// Cập nhật khóa khi hàng row (16 bit) của bàn 4x4 đổi từ oldRow sang newRow
+inline uint64_t updateRowHash(uint64_t hash, int row, uint16_t oldRow, uint16_t newRow)
+{
+    return updateHash<4>(hash, oldRow, newRow, row * BOARD_SIZE);
+}
+
+// Cập nhật khóa khi sinh ô mới vào một ô trống
+inline uint64_t spawnHash(uint64_t hash, int cell, int exponent)
+{
+    return hash ^ zobristKey(cell, exponent);
+}
+
+// Cách trộn khóa trước khi lấy chỉ số bảng kích thước 2^bits
+enum HashMix
+{
+    HASH_MIX_NONE,      // lấy thẳng bit thấp: khóa Zobrist đã đủ ngẫu nhiên, nhanh nhất
+    HASH_MIX_FIBONACCI, // nhân với 2^64 / phi rồi lấy bit cao
+    HASH_MIX_FULL       // bước trộn cuối của splitmix64, dùng khi khóa không phải Zobrist
+};
+
+template <HashMix MIX = HASH_MIX_FIBONACCI>
+inline uint64_t tableIndex(uint64_t hash, int bits)
+{
+    if (MIX == HASH_MIX_NONE)
+    {
+        return hash & ((uint64_t(1) << bits) - 1);
+    }
+    if (MIX == HASH_MIX_FULL)
+    {
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        hash ^= hash >> 31;
+        return hash & ((uint64_t(1) << bits) - 1);
+    }
+    return bits == 0 ? 0 : (hash * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include "advisor.h"
+#include "chance.h"
+#include "move_table.h"
+
+Advisor::Advisor(const SearchLimits &limits, bool ponder)
+    : limits_(limits), ponder_(ponder), cancel_(false), quit_(false), pending_(false), running_(false), targeted_(false),
+      board_(0), known_(false), knownBoard_(0), move_(-1), ponderParent_(0), ponderCount_(0), ponderLookups_(0), ponderHits_(0)
+{
+    limits_.cancel = &cancel_;
+    worker_ = std::thread(&Advisor::workerLoop, this);
+}
+
+Advisor::~Advisor()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        quit_ = true;
+        cancel_ = true;
+    }
+    wakeUp_.notify_one();
+    worker_.join();
+}
+
+void Advisor::start(Board board)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (targeted_ && board_ == board)
+        {
+            return;
+        }
+        if (ponder_ && !(known_ && knownBoard_ == board))
+        {
+            ++ponderLookups_;
+            for (int i = 0; i < ponderCount_; ++i)
+            {
+                if (ponderBoards_[i] == board)
+                {
+                    known_ = true;
+                    knownBoard_ = board;
+                    move_ = ponderMoves_[i];
+                    ++ponderHits_;
+                    break;
+                }
+            }
+        }
+        // Lượt đang chạy thấy cờ hủy trong khoảng 0.1 ms; luồng tự hạ cờ khi nhận board mới
+        cancel_ = running_;
+        board_ = board;
+        pending_ = true;
+        targeted_ = true;
+    }
+    wakeUp_.notify_one();
+}
+
+void Advisor::cancel()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    cancel_ = running_;
+    pending_ = false;
+    targeted_ = false;
+}
+
+void Advisor::wait()
+{
+    std::unique_lock<std::mutex> guard(lock_);
+    idle_.wait(guard, [this] { return !running_; });
+}
+
+void Advisor::forget()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    known_ = false;
+    targeted_ = false;
+    ponderCount_ = 0;
+}
+
+bool Advisor::result(Board board, int &move)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!known_ || knownBoard_ != board)
+    {
+        return false;
+    }
+    move = move_;
+    return true;
+}
+
+// Gọi khi đang giữ lock_: lượt hiện tại đã bị hủy hoặc có bàn cờ mới đang chờ
+bool Advisor::interrupted()
+{
+    return cancel_ || pending_;
+}
+
+void Advisor::workerLoop()
+{
+    std::unique_lock<std::mutex> guard(lock_);
+    for (;;)
+    {
+        wakeUp_.wait(guard, [this] { return quit_ || pending_; });
+        if (quit_)
+        {
+            return;
+        }
+        Board board = board_;
+        pending_ = false;
+        running_ = true;
+        cancel_ = false;
+        bool known = known_ && knownBoard_ == board;
+        int move = move_;
+        guard.unlock();
+
+        if (!known)
+        {
+            move = searchMove(board, limits_).move;
+            guard.lock();
+            // Kết quả của lượt bị hủy hoặc đã có board mới thì bỏ
+            known = !interrupted();
+            if (known)
+            {
+                known_ = true;
+                knownBoard_ = board;
+                move_ = move;
+            }
+            guard.unlock();
+        }
+        if (known && ponder_)
+        {
+            ponder(board, move);
+        }
+
+        guard.lock();
+        running_ = false;
+        idle_.notify_all();
+    }
+}
+
+// Tìm trước mọi bàn cờ sau một nước của board và một ô sinh ra, theo thứ tự khả năng xảy ra:
+// nước được gợi ý trước (người chơi hay đi theo), trong mỗi nước các ô 2 trước các ô 4.
+// Thứ tự chỉ phụ thuộc board và hint, nên khi lượt trước của cùng board bị hủy (phím không làm
+// đổi bàn cờ) thì giữ các mục đã có và bỏ qua đúng chừng đó kết quả đầu tiên.
+void Advisor::ponder(Board board, int hint)
+{
+    if (hint < 0)
+    {
+        return;
+    }
+    int done;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (interrupted())
+        {
+            return;
+        }
+        if (ponderParent_ != board)
+        {
+            ponderParent_ = board;
+            ponderCount_ = 0;
+        }
+        done = ponderCount_;
+    }
+    int index = 0;
+    int order[4] = {hint};
+    for (int dir = 0, count = 1; dir < 4; ++dir)
+    {
+        if (dir != hint)
+        {
+            order[count++] = dir;
+        }
+    }
+    for (int dir : order)
+    {
+        Board afterstate = board;
+        int gain;
+        if (!moveBoardTable(afterstate, Direction(dir), gain))
+        {
+            continue;
+        }
+        for (int kind = 0; kind < ClassicSpawn::KINDS; ++kind)
+        {
+            for (ChanceOutcome outcome : ChanceOutcomes<>(afterstate))
+            {
+                if (outcome.exponent != ClassicSpawn::exponent(kind) || index++ < done)
+                {
+                    continue;
+                }
+                if (cancel_)
+                {
+                    return;
+                }
+                int move = searchMove(outcome.board, limits_).move;
+                std::lock_guard<std::mutex> guard(lock_);
+                if (interrupted())
+                {
+                    return;
+                }
+                ponderBoards_[ponderCount_] = outcome.board;
+                ponderMoves_[ponderCount_++] = int8_t(move);
+            }
+        }
+    }
+}
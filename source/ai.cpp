@@ -0,0 +1,539 @@
+#include "ai.h"
+#include "chance.h"
+#include "heuristic.h"
+#include "move_simd.h"
+#include "move_table.h"
+#include "symmetry.h"
+#include "transposition.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static bool tableKernel(Board &board, Direction dir, int &scoreGain)
+{
+    return moveBoardTable(board, dir, scoreGain);
+}
+
+static bool scalarKernel(Board &board, Direction dir, int &scoreGain)
+{
+    return moveBoard(board, dir, scoreGain);
+}
+
+static bool simdKernel(Board &board, Direction dir, int &scoreGain)
+{
+    return moveBoardSimd(board, dir, scoreGain);
+}
+
+// Khi cắt nhánh theo xác suất, giá trị trong bảng nhớ tạm phụ thuộc xác suất tích lũy lúc tìm.
+// Mục được dùng lại nếu đã tìm ở xác suất không nhỏ hơn 1/PROBABILITY_SLACK xác suất hiện tại;
+// đòi đúng bằng thì gần như không trúng bảng và tổng số nút còn tăng lên.
+static const float PROBABILITY_SLACK = 16;
+
+static float reuseProbability(const SearchLimits &limits, float probability)
+{
+    return limits.minProbability > 0 ? probability / PROBABILITY_SLACK : 0;
+}
+
+// Các ô trống được mở ở nút chance: tất cả, hoặc maxSamples ô chọn ngẫu nhiên khi bàn còn quá nhiều ô trống.
+// Rng lấy seed từ chính bàn cờ để cùng một nút luôn mở cùng các ô, giá trị trong bảng nhớ tạm vẫn nhất quán.
+static Board chanceCells(Board afterstate, int maxSamples)
+{
+    Board empty = emptyMask(afterstate);
+    int count = __builtin_popcountll(empty);
+    if (maxSamples <= 0 || count <= maxSamples)
+    {
+        return empty;
+    }
+    Rng rng = makeRng(afterstate);
+    Board chosen = 0;
+    for (int k = 0; k < maxSamples; ++k, --count)
+    {
+        Board bit = Board(1) << selectBit(empty, randomBelow(rng, count));
+        chosen |= bit;
+        empty &= ~bit;
+    }
+    return chosen;
+}
+
+// Điều khiển dừng chung cho mọi Searcher của một lần tìm: khi hết giờ hoặc bị hủy, mọi nút chance còn lại
+// trả về ngay giá trị đánh giá và kết quả của lượt đó bị bỏ
+class SearchControl
+{
+public:
+    // Số nút giữa hai lần đọc đồng hồ và cờ hủy, khoảng 0.1 ms ở tốc độ tìm hiện tại
+    static const uint64_t POLL_NODES = 4096;
+
+    SearchControl(const SearchLimits &limits, Clock::time_point start)
+        : cancel_(limits.cancel), timed_(limits.moveMs > 0), stopped_(false)
+    {
+        deadline_ = start + chrono::duration_cast<Clock::duration>(chrono::duration<double, milli>(limits.moveMs));
+    }
+
+    bool stopped() const
+    {
+        return stopped_.load(memory_order_relaxed);
+    }
+
+    bool poll()
+    {
+        if (!stopped() && ((cancel_ && cancel_->load(memory_order_relaxed)) || (timed_ && Clock::now() >= deadline_)))
+        {
+            stopped_.store(true, memory_order_relaxed);
+        }
+        return stopped();
+    }
+
+    // Số ms còn lại tới hạn moveMs
+    double remainingMs() const
+    {
+        return chrono::duration<double, milli>(deadline_ - Clock::now()).count();
+    }
+
+private:
+    const atomic<bool> *cancel_;
+    bool timed_;
+    Clock::time_point deadline_;
+    atomic<bool> stopped_;
+};
+
+// Cây tìm kiếm với kernel di chuyển là tham số template để trình biên dịch gọi thẳng
+template <bool (*MOVE)(Board &, Direction, int &)>
+class Searcher
+{
+public:
+    // sharedNodes (nếu có) là số nút các task khác đã tìm xong, cộng vào khi so với ngân sách nút;
+    // control (nếu có) dừng cây khi hết giờ
+    Searcher(const SearchLimits &limits, const HeuristicTables &heuristic, SearchControl *control = nullptr,
+             const atomic<uint64_t> *sharedNodes = nullptr)
+        : limits_(limits), heuristic_(heuristic), control_(control), sharedNodes_(sharedNodes), nodes_(0), nextPoll_(0),
+          stopped_(false), ttProbes_(0), ttHits_(0)
+    {
+    }
+
+    // Giá trị của nút max và hướng tốt nhất; bàn cờ không còn nước đi có giá trị 0.
+    // probability là xác suất tích lũy để đi tới nút này
+    float maxNode(Board board, int depth, float probability, int &bestMove)
+    {
+        ++nodes_;
+        float best = 0;
+        bestMove = -1;
+        for (int d = 0; d < 4; ++d)
+        {
+            Board after = board;
+            int gain;
+            if (!MOVE(after, Direction(d), gain))
+            {
+                continue;
+            }
+            float value = chanceNode(after, depth, probability);
+            if (bestMove < 0 || value > best)
+            {
+                best = value;
+                bestMove = d;
+            }
+        }
+        return best;
+    }
+
+    uint64_t nodes() const { return nodes_; }
+    uint64_t ttProbes() const { return ttProbes_; }
+    uint64_t ttHits() const { return ttHits_; }
+
+    // Hết ngân sách nút hoặc hết giờ
+    bool shouldStop()
+    {
+        if (control_ && nodes_ >= nextPoll_)
+        {
+            nextPoll_ = nodes_ + SearchControl::POLL_NODES;
+            stopped_ = control_->poll();
+        }
+        if (stopped_ || !limits_.nodeBudget)
+        {
+            return stopped_;
+        }
+        uint64_t spent = nodes_ + (sharedNodes_ ? sharedNodes_->load(memory_order_relaxed) : 0);
+        return spent >= limits_.nodeBudget;
+    }
+
+    float chanceNode(Board afterstate, int depth, float probability)
+    {
+        ++nodes_;
+        if (depth <= 1 || probability < limits_.minProbability || shouldStop())
+        {
+            return heuristic_.evaluate(afterstate);
+        }
+
+        TranspositionTable *table = limits_.table;
+        Board key = limits_.canonical ? canonicalBoard(afterstate) : afterstate;
+        float sum = 0;
+        if (table)
+        {
+            ++ttProbes_;
+            if (table->probe(key, depth, reuseProbability(limits_, probability), sum))
+            {
+                ++ttHits_;
+                return sum;
+            }
+        }
+
+        int move;
+        for (ChanceOutcome outcome : ChanceOutcomes<>(afterstate, chanceCells(afterstate, limits_.maxSamples)))
+        {
+            sum += outcome.probability * maxNode(outcome.board, depth - 1, probability * outcome.probability, move);
+        }
+        // Giá trị tính dở khi hết ngân sách nút hay hết giờ không được ghi lại
+        if (table && !shouldStop())
+        {
+            table->store(key, depth, probability, sum);
+        }
+        return sum;
+    }
+
+private:
+    const SearchLimits &limits_;
+    const HeuristicTables &heuristic_;
+    SearchControl *control_;
+    const atomic<uint64_t> *sharedNodes_;
+    uint64_t nodes_;
+    uint64_t nextPoll_;
+    bool stopped_;
+    uint64_t ttProbes_;
+    uint64_t ttHits_;
+};
+
+// Tìm song song: các tầng đầu cây (nút max gốc, các nút chance con của nó, ...) được chia thành task
+// trên WorkPool, từ tầng splitPlies trở xuống mỗi task tìm tuần tự bằng một Searcher riêng
+template <bool (*MOVE)(Board &, Direction, int &)>
+class ParallelSearch
+{
+public:
+    ParallelSearch(const SearchLimits &limits, const HeuristicTables &heuristic, SearchControl *control)
+        : limits_(limits), heuristic_(heuristic), control_(control), nodes_(0), ttProbes_(0), ttHits_(0)
+    {
+    }
+
+    float maxNode(Board board, int depth, float probability, int ply, int &bestMove)
+    {
+        if (ply >= limits_.splitPlies)
+        {
+            Searcher<MOVE> searcher(limits_, heuristic_, control_, &nodes_);
+            float value = searcher.maxNode(board, depth, probability, bestMove);
+            collect(searcher);
+            return value;
+        }
+
+        nodes_.fetch_add(1, memory_order_relaxed);
+        ChanceTask tasks[4];
+        TaskGroup group;
+        for (int d = 0; d < 4; ++d)
+        {
+            tasks[d].search = this;
+            tasks[d].board = board;
+            int gain;
+            tasks[d].legal = MOVE(tasks[d].board, Direction(d), gain);
+            if (tasks[d].legal)
+            {
+                tasks[d].depth = depth;
+                tasks[d].probability = probability;
+                tasks[d].ply = ply + 1;
+                limits_.pool->submit(group, ChanceTask::run, &tasks[d]);
+            }
+        }
+        limits_.pool->wait(group);
+
+        float best = 0;
+        bestMove = -1;
+        for (int d = 0; d < 4; ++d)
+        {
+            if (tasks[d].legal && (bestMove < 0 || tasks[d].value > best))
+            {
+                best = tasks[d].value;
+                bestMove = d;
+            }
+        }
+        return best;
+    }
+
+    float chanceNode(Board afterstate, int depth, float probability, int ply)
+    {
+        if (ply >= limits_.splitPlies || depth <= 1 || probability < limits_.minProbability)
+        {
+            Searcher<MOVE> searcher(limits_, heuristic_, control_, &nodes_);
+            float value = searcher.chanceNode(afterstate, depth, probability);
+            collect(searcher);
+            return value;
+        }
+
+        nodes_.fetch_add(1, memory_order_relaxed);
+        TranspositionTable *table = limits_.table;
+        Board key = limits_.canonical ? canonicalBoard(afterstate) : afterstate;
+        float sum = 0;
+        if (table)
+        {
+            ttProbes_.fetch_add(1, memory_order_relaxed);
+            if (table->probe(key, depth, reuseProbability(limits_, probability), sum))
+            {
+                ttHits_.fetch_add(1, memory_order_relaxed);
+                return sum;
+            }
+        }
+
+        // Tối đa 16 ô trống x 2 loại ô
+        MaxTask tasks[2 * BOARD_CELLS];
+        int count = 0;
+        TaskGroup group;
+        for (ChanceOutcome outcome : ChanceOutcomes<>(afterstate, chanceCells(afterstate, limits_.maxSamples)))
+        {
+            MaxTask &task = tasks[count++];
+            task.search = this;
+            task.board = outcome.board;
+            task.weight = outcome.probability;
+            task.depth = depth - 1;
+            task.probability = probability * outcome.probability;
+            task.ply = ply + 1;
+            limits_.pool->submit(group, MaxTask::run, &task);
+        }
+        limits_.pool->wait(group);
+        for (int i = 0; i < count; ++i)
+        {
+            sum += tasks[i].weight * tasks[i].value;
+        }
+
+        bool stopped = (control_ && control_->stopped()) ||
+                       (limits_.nodeBudget && nodes_.load(memory_order_relaxed) >= limits_.nodeBudget);
+        if (table && !stopped)
+        {
+            table->store(key, depth, probability, sum);
+        }
+        return sum;
+    }
+
+    void fillStats(SearchStats &stats) const
+    {
+        stats.nodes = nodes_.load();
+        stats.ttProbes = ttProbes_.load();
+        stats.ttHits = ttHits_.load();
+    }
+
+private:
+    struct ChanceTask
+    {
+        ParallelSearch *search;
+        Board board;
+        bool legal;
+        int depth;
+        float probability;
+        int ply;
+        float value;
+
+        static void run(void *arg)
+        {
+            ChanceTask &task = *static_cast<ChanceTask *>(arg);
+            task.value = task.search->chanceNode(task.board, task.depth, task.probability, task.ply);
+        }
+    };
+
+    struct MaxTask
+    {
+        ParallelSearch *search;
+        Board board;
+        float weight;
+        int depth;
+        float probability;
+        int ply;
+        float value;
+
+        static void run(void *arg)
+        {
+            MaxTask &task = *static_cast<MaxTask *>(arg);
+            int move;
+            task.value = task.search->maxNode(task.board, task.depth, task.probability, task.ply, move);
+        }
+    };
+
+    void collect(const Searcher<MOVE> &searcher)
+    {
+        nodes_.fetch_add(searcher.nodes(), memory_order_relaxed);
+        ttProbes_.fetch_add(searcher.ttProbes(), memory_order_relaxed);
+        ttHits_.fetch_add(searcher.ttHits(), memory_order_relaxed);
+    }
+
+    const SearchLimits &limits_;
+    const HeuristicTables &heuristic_;
+    SearchControl *control_;
+    atomic<uint64_t> nodes_;
+    atomic<uint64_t> ttProbes_;
+    atomic<uint64_t> ttHits_;
+};
+
+// Một lượt tìm tới độ sâu depth; control (nếu có) dừng lượt khi hết giờ
+template <bool (*MOVE)(Board &, Direction, int &)>
+static SearchResult runSearch(Board board, const SearchLimits &limits, int depth, SearchControl *control)
+{
+    const HeuristicTables &heuristic = heuristicTables();
+    SearchResult result;
+    result.stats = SearchStats();
+    if (limits.pool && limits.pool->threads() > 1)
+    {
+        ParallelSearch<MOVE> search(limits, heuristic, control);
+        result.value = search.maxNode(board, depth, 1, 0, result.move);
+        search.fillStats(result.stats);
+    }
+    else
+    {
+        Searcher<MOVE> searcher(limits, heuristic, control);
+        result.value = searcher.maxNode(board, depth, 1, result.move);
+        result.stats.nodes = searcher.nodes();
+        result.stats.ttProbes = searcher.ttProbes();
+        result.stats.ttHits = searcher.ttHits();
+    }
+    result.stats.depth = depth;
+    return result;
+}
+
+// Tìm sâu dần 1, 2, ... tới limits.depth cho tới hạn moveMs; trả về kết quả của lượt sâu nhất đã xong.
+// Bảng nhớ tạm chỉ nhận mục có độ sâu còn lại không nhỏ hơn độ sâu cần, mà lượt trước lưu mỗi bàn cờ
+// thấp hơn lượt sau một bậc, nên các lượt hầu như không dùng lại kết quả của nhau.
+// Thời gian mỗi lượt tăng theo hệ số nhánh, ước từ hai lượt gần nhất; lượt sau chắc chắn không xong
+// trước hạn thì không bắt đầu, thay vì chạy rồi bỏ.
+template <bool (*MOVE)(Board &, Direction, int &)>
+static SearchResult deepenSearch(Board board, const SearchLimits &limits, SearchControl &control)
+{
+    SearchResult best;
+    best.move = -1;
+    best.value = 0;
+    best.stats = SearchStats();
+    uint64_t lastNodes = 0;
+    for (int depth = 1; depth <= limits.depth; ++depth)
+    {
+        Clock::time_point start = Clock::now();
+        SearchResult result = runSearch<MOVE>(board, limits, depth, &control);
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        best.stats.nodes += result.stats.nodes;
+        best.stats.ttProbes += result.stats.ttProbes;
+        best.stats.ttHits += result.stats.ttHits;
+        // Lượt bị dừng giữa chừng chỉ được dùng khi chưa có lượt nào xong
+        if (control.stopped() && best.move >= 0)
+        {
+            break;
+        }
+        best.move = result.move;
+        best.value = result.value;
+        best.stats.depth = depth;
+        if (control.stopped() || result.move < 0)
+        {
+            break;
+        }
+        // Tỉ lệ số nút giữa hai lượt liền nhau giảm dần theo độ sâu (khoảng 9, 6, 3.7, 3.2), nên ước
+        // lượt sau tốn 2/3 tỉ lệ vừa đo nhân với thời gian lượt này
+        if (lastNodes > 0 && ms * result.stats.nodes / lastNodes * 2 / 3 > control.remainingMs())
+        {
+            break;
+        }
+        lastNodes = result.stats.nodes;
+    }
+    return best;
+}
+
+template <bool (*MOVE)(Board &, Direction, int &)>
+static SearchResult timedSearch(Board board, const SearchLimits &limits)
+{
+    Clock::time_point start = Clock::now();
+    if (limits.table)
+    {
+        limits.table->newSearch();
+    }
+    SearchControl control(limits, start);
+    SearchResult result = limits.moveMs > 0 ? deepenSearch<MOVE>(board, limits, control)
+                                            : runSearch<MOVE>(board, limits, limits.depth, limits.cancel ? &control : nullptr);
+    result.stats.ms = chrono::duration<double, milli>(Clock::now() - start).count();
+    result.stats.overrunMs = limits.moveMs > 0 && result.stats.ms > limits.moveMs ? result.stats.ms - limits.moveMs : 0;
+    return result;
+}
+
+SearchResult searchMove(Board board, const SearchLimits &limits)
+{
+    if (limits.kernel == SEARCH_SCALAR)
+    {
+        return timedSearch<scalarKernel>(board, limits);
+    }
+    if (limits.kernel == SEARCH_SIMD && simdMoveAvailable())
+    {
+        return timedSearch<simdKernel>(board, limits);
+    }
+    return timedSearch<tableKernel>(board, limits);
+}
+
+HeadlessSummary playHeadless(int games, uint64_t seed, const SearchLimits &limits, bool verbose)
+{
+    uint64_t totalNodes = 0, totalMoves = 0;
+    double totalMs = 0;
+    double totalScore = 0;
+    uint64_t ttProbes = 0, ttHits = 0;
+    uint64_t searches = 0, depthSum = 0;
+    double overrunSum = 0, overrunMax = 0;
+    for (int g = 0; g < games; ++g)
+    {
+        Rng rng = makeRng(seed + g);
+        Board board = 0;
+        spawnTile(board, rng);
+        spawnTile(board, rng);
+        int score = 0, moves = 0;
+        uint64_t nodes = 0;
+        double ms = 0;
+        for (;;)
+        {
+            SearchResult result = searchMove(board, limits);
+            nodes += result.stats.nodes;
+            ms += result.stats.ms;
+            ttProbes += result.stats.ttProbes;
+            ttHits += result.stats.ttHits;
+            ++searches;
+            depthSum += result.stats.depth;
+            overrunSum += result.stats.overrunMs;
+            overrunMax = max(overrunMax, result.stats.overrunMs);
+            if (result.move < 0)
+            {
+                break;
+            }
+            int gain;
+            moveBoardTable(board, Direction(result.move), gain);
+            score += gain;
+            ++moves;
+            spawnTile(board, rng);
+        }
+        totalNodes += nodes;
+        totalMs += ms;
+        totalScore += score;
+        totalMoves += moves;
+        if (!verbose)
+        {
+            continue;
+        }
+        cout << "game " << g + 1 << ": seed " << seed + g << ", score " << score << ", max tile " << tileValue(maxTile(board))
+             << ", moves " << moves << ", " << (ms > 0 ? nodes / ms / 1e3 : 0) << " M nodes/s\n";
+    }
+    HeadlessSummary summary = {games ? totalScore / games : 0, totalMoves, totalNodes, totalMs};
+    if (!verbose)
+    {
+        return summary;
+    }
+    cout << "depth " << limits.depth << ", node budget " << limits.nodeBudget << ": average score " << totalScore / games << ", " << totalNodes << " nodes, "
+         << (totalMs > 0 ? totalNodes / totalMs / 1e3 : 0) << " M nodes/s\n";
+    if (limits.moveMs > 0 && searches)
+    {
+        cout << "time limit " << limits.moveMs << " ms: average depth " << double(depthSum) / searches << ", overrun average "
+             << overrunSum / searches << " ms, max " << overrunMax << " ms\n";
+    }
+    if (limits.table)
+    {
+        cout << "transposition table: " << (limits.table->memoryBytes() >> 20) << " MB, " << ttProbes << " probes, hit rate "
+             << (ttProbes ? 100.0 * ttHits / ttProbes : 0) << "%\n";
+    }
+    return summary;
+}
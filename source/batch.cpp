@@ -0,0 +1,144 @@
+#include "batch.h"
+#include "move_simd.h"
+#include "spawn.h"
+#include <cstring>
+
+typedef GridEngine<4, 4> NarrowEngine;
+typedef GridEngine<4, 4, WIDE_CELL_BITS> WideEngine;
+
+// Bản xem 4 bit của bàn rộng, ô lớn hơn 32768 bị chặn ở MAX_EXPONENT
+static Board narrowView(const WideBoard &wide)
+{
+    Board board = 0;
+    for (int n = 0; n < BOARD_CELLS; ++n)
+    {
+        int exponent = WideEngine::getTile(wide, n / BOARD_SIZE, n % BOARD_SIZE);
+        board |= Board(exponent < MAX_EXPONENT ? exponent : MAX_EXPONENT) << (4 * n);
+    }
+    return board;
+}
+
+// Đi một bước trên bố cục 8 bit, dùng cho ván đã có ô 32768
+static void stepWide(WideBoard &wide, Direction dir, Rng &rng, Board &next, int32_t &reward, uint8_t &done,
+                     uint8_t &legal)
+{
+    GridStatus status;
+    WideEngine::scanStatus(wide, status);
+    int gain = 0;
+    bool moved;
+    switch (dir)
+    {
+    case DIR_UP:
+        moved = WideEngine::move<DIR_UP>(wide, gain, nullptr, &status);
+        break;
+    case DIR_DOWN:
+        moved = WideEngine::move<DIR_DOWN>(wide, gain, nullptr, &status);
+        break;
+    case DIR_LEFT:
+        moved = WideEngine::move<DIR_LEFT>(wide, gain, nullptr, &status);
+        break;
+    default:
+        moved = WideEngine::move<DIR_RIGHT>(wide, gain, nullptr, &status);
+        break;
+    }
+    if (moved)
+    {
+        WideEngine::spawn(wide, rng, &status);
+    }
+    reward = moved ? gain : 0;
+    legal = uint8_t(statusLegalMoves<4, 4>(status));
+    done = legal == 0;
+    next = narrowView(wide);
+}
+
+// Phần sau khi đi: sinh ô mới và tính các nước đi hợp lệ của bàn cờ kết quả.
+// Có ô 32768 thì chuyển ván sang wide, vì bảng tra 4 bit coi hai ô 32768 là không gộp được
+static inline void finishStep(Board before, Board after, int gain, Rng &rng, Board &next, int32_t &reward,
+                              uint8_t &done, uint8_t &legal, uint8_t &escaped, WideBoard &wide)
+{
+    if (after != before)
+    {
+        spawnTile(after, rng);
+        reward = gain;
+    }
+    else
+    {
+        reward = 0;
+    }
+    next = after;
+    if (emptyMask(~after) != 0) // có nibble 0xF
+    {
+        convertGrid<NarrowEngine, WideEngine>(after, wide, BOARD_SIZE, BOARD_SIZE);
+        GridStatus status;
+        WideEngine::scanStatus(wide, status);
+        legal = uint8_t(statusLegalMoves<4, 4>(status));
+        escaped = 1;
+    }
+    else
+    {
+        legal = legalMoves(after);
+    }
+    done = legal == 0;
+}
+
+// Một ván: ván đã ở bố cục rộng, hoặc bàn 4 bit đưa vào đã có ô 32768, thì đi trên wide
+static void stepSingle(MoveKernel kernel, Board before, Direction dir, Rng &rng, Board &next, int32_t &reward,
+                       uint8_t &done, uint8_t &legal, uint8_t &escaped, WideBoard &wide)
+{
+    if (escaped || emptyMask(~before) != 0)
+    {
+        if (!escaped)
+        {
+            convertGrid<NarrowEngine, WideEngine>(before, wide, BOARD_SIZE, BOARD_SIZE);
+            escaped = 1;
+        }
+        stepWide(wide, dir, rng, next, reward, done, legal);
+        return;
+    }
+    Board after = before;
+    int gain = 0;
+    kernel(after, dir, gain);
+    finishStep(before, after, gain, rng, next, reward, done, legal, escaped, wide);
+}
+
+void stepBatch(int count, const Board *boards, const uint8_t *actions, Rng *rngs, Board *nextBoards,
+               int32_t *rewards, uint8_t *done, uint8_t *legalMoves, uint8_t *escaped, WideBoard *wideBoards)
+{
+    MoveKernel kernel = bestMoveKernel();
+    int i = 0;
+    // AVX2 đi 4 bàn cờ một lúc, không rẽ nhánh theo hướng đi: phần đi nhanh hơn bảng tra từng bàn
+    // (100 so với 61 M nước/s, --bench batch); cả bước vẫn chủ yếu là sinh ô và tính nước hợp lệ
+    if (avx2MoveAvailable())
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            uint32_t wideGroup;
+            memcpy(&wideGroup, escaped + i, sizeof(wideGroup));
+            Board fifteens = emptyMask(~boards[i]) | emptyMask(~boards[i + 1]) | emptyMask(~boards[i + 2]) |
+                             emptyMask(~boards[i + 3]);
+            if (wideGroup != 0 || fifteens != 0)
+            {
+                // Nhóm có ván rộng thì đi từng ván
+                for (int k = i; k < i + 4; ++k)
+                {
+                    stepSingle(kernel, boards[k], Direction(actions[k] & 3), rngs[k], nextBoards[k], rewards[k],
+                               done[k], legalMoves[k], escaped[k], wideBoards[k]);
+                }
+                continue;
+            }
+            Board after[4];
+            int gains[4];
+            moveBoardsAvx2(boards + i, actions + i, after, gains);
+            for (int k = 0; k < 4; ++k)
+            {
+                finishStep(boards[i + k], after[k], gains[k], rngs[i + k], nextBoards[i + k], rewards[i + k],
+                           done[i + k], legalMoves[i + k], escaped[i + k], wideBoards[i + k]);
+            }
+        }
+    }
+    for (; i < count; ++i)
+    {
+        stepSingle(kernel, boards[i], Direction(actions[i] & 3), rngs[i], nextBoards[i], rewards[i], done[i],
+                   legalMoves[i], escaped[i], wideBoards[i]);
+    }
+}
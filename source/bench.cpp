@@ -0,0 +1,583 @@
+#include "bench.h"
+#include "ai.h"
+#include "advisor.h"
+#include "batch.h"
+#include "heuristic.h"
+#include "transposition.h"
+#include "work_pool.h"
+#include "move_table.h"
+#include "move_simd.h"
+#include "rng.h"
+#include "spawn.h"
+#include "symmetry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// Đọc hết một bộ bảng để mọi trang bộ nhớ đều được nạp
+static uint32_t touchTables(const RowTables &tables)
+{
+    uint32_t sum = 0;
+    for (int row = 0; row < ROW_COUNT; ++row)
+    {
+        sum += tables.result[row] + tables.score[row] + tables.targets[row] + tables.merges[row];
+    }
+    return sum;
+}
+
+// So sánh thời gian khởi động: bảng constexpr sẵn trong .rodata với việc dựng bảng lúc chạy trong initialize()
+static void benchStartup()
+{
+    Clock::time_point start = Clock::now();
+    uint32_t sum = touchTables(leftRowTables) + touchTables(rightRowTables);
+    double staticMs = elapsedMs(start);
+
+    const int runs = 20;
+    start = Clock::now();
+    for (int i = 0; i < runs; ++i)
+    {
+        unique_ptr<RowTables> left(new RowTables(false));
+        unique_ptr<RowTables> right(new RowTables(true));
+        sum += touchTables(*left) + touchTables(*right);
+    }
+    double runtimeMs = elapsedMs(start) / runs;
+
+    cout << "startup: constexpr tables (first touch) " << staticMs << " ms, runtime build " << runtimeMs
+         << " ms (checksum " << sum << ")\n";
+}
+
+// Bàn cờ ngẫu nhiên cố định để các kernel chạy trên cùng dữ liệu
+static vector<Board> sampleBoards(int count)
+{
+    vector<Board> boards(count);
+    uint64_t seed = 0x2048;
+    for (int i = 0; i < count; ++i)
+    {
+        Board board = 0;
+        for (int c = 0; c < BOARD_CELLS; ++c)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            int exponent = (seed >> 60) < 5 ? 0 : (seed >> 40) % 12;
+            board |= Board(exponent) << (4 * c);
+        }
+        boards[i] = board;
+    }
+    return boards;
+}
+
+static void benchKernel(const char *label, MoveKernel kernel, const vector<Board> &boards)
+{
+    const int rounds = 200;
+    uint64_t checksum = 0;
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            Board board = boards[i];
+            int gain = 0;
+            kernel(board, Direction((i + round) & 3), gain);
+            checksum += board + gain;
+        }
+    }
+    double seconds = elapsedMs(start) / 1000;
+    double moves = double(rounds) * boards.size();
+    cout << label << ": " << moves / seconds / 1e6 << " M moves/s (checksum " << checksum << ")\n";
+}
+
+static bool moveBoardScalarKernel(Board &board, Direction dir, int &scoreGain)
+{
+    return moveBoard(board, dir, scoreGain);
+}
+
+static bool moveBoardTableKernel(Board &board, Direction dir, int &scoreGain)
+{
+    return moveBoardTable(board, dir, scoreGain);
+}
+
+// Tốc độ các kernel di chuyển: vòng lặp từng ô, bảng tra và SIMD
+static void benchMoves()
+{
+    vector<Board> boards = sampleBoards(4096);
+    benchKernel("scalar", moveBoardScalarKernel, boards);
+    benchKernel("table", moveBoardTableKernel, boards);
+    if (simdMoveAvailable())
+    {
+        benchKernel("simd", moveBoardSimd, boards);
+    }
+    else
+    {
+        cout << "simd: not supported by this CPU\n";
+    }
+}
+
+// Bước đồng loạt: đi từng bàn cờ bằng bảng tra so với AVX2 đi 4 bàn một lúc, rồi cả stepBatch
+static void benchBatch()
+{
+    const int count = 4096;
+    const int rounds = 200;
+    vector<Board> boards = sampleBoards(count);
+    vector<uint8_t> actions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        actions[i] = uint8_t((i * 7 + i / 5) & 3);
+    }
+    vector<Board> after(count);
+    vector<int> gains(count);
+    double steps = double(rounds) * count;
+
+    uint64_t checksum = 0;
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            after[i] = boards[i];
+            moveBoardTable(after[i], Direction(actions[i]), gains[i]);
+        }
+        checksum += after[round] + gains[round];
+    }
+    cout << "batch moves, table: " << steps / (elapsedMs(start) / 1000) / 1e6 << " M moves/s (checksum "
+         << checksum << ")\n";
+
+    if (avx2MoveAvailable())
+    {
+        checksum = 0;
+        start = Clock::now();
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (int i = 0; i < count; i += 4)
+            {
+                moveBoardsAvx2(&boards[i], &actions[i], &after[i], &gains[i]);
+            }
+            checksum += after[round] + gains[round];
+        }
+        cout << "batch moves, avx2 x4: " << steps / (elapsedMs(start) / 1000) / 1e6 << " M moves/s (checksum "
+             << checksum << ")\n";
+    }
+    else
+    {
+        cout << "batch moves, avx2 x4: not supported by this CPU\n";
+    }
+
+    vector<Rng> rngs(count);
+    for (int i = 0; i < count; ++i)
+    {
+        rngs[i] = makeRng(0x2048 + i);
+    }
+    vector<Board> next(count);
+    vector<int32_t> rewards(count);
+    vector<uint8_t> done(count), legal(count), escaped(count);
+    vector<WideBoard> wide(count);
+    checksum = 0;
+    start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        stepBatch(count, boards.data(), actions.data(), rngs.data(), next.data(), rewards.data(), done.data(),
+                  legal.data(), escaped.data(), wide.data());
+        checksum += next[round] + rewards[round] + legal[round];
+    }
+    cout << "stepBatch: " << steps / (elapsedMs(start) / 1000) / 1e6 << " M steps/s (checksum " << checksum
+         << ")\n";
+}
+
+// Tốc độ rand() của thư viện C so với xoshiro256**
+static void benchRng()
+{
+    const int draws = 50000000;
+    uint64_t sum = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < draws; ++i)
+    {
+        sum += rand() % 10;
+    }
+    double randMs = elapsedMs(start);
+
+    Rng rng = makeRng(2048);
+    start = Clock::now();
+    for (int i = 0; i < draws; ++i)
+    {
+        sum += randomBelow(rng, 10);
+    }
+    double rngMs = elapsedMs(start);
+
+    cout << "rand(): " << draws / randMs / 1e3 << " M draws/s, xoshiro256**: " << draws / rngMs / 1e3
+         << " M draws/s (checksum " << sum << ")\n";
+}
+
+// Đại diện nhỏ nhất tính theo từng ô: xoay 4 lần, mỗi lần so cả bản lật, để so với bản song song bit
+static Board canonicalBoardByCells(Board board)
+{
+    Board best = board;
+    Board rotated = board;
+    for (int r = 0; r < 4; ++r)
+    {
+        Board next = 0;
+        Board mirrored = 0;
+        for (int i = 0; i < BOARD_SIZE; ++i)
+        {
+            for (int j = 0; j < BOARD_SIZE; ++j)
+            {
+                next = setTile(next, j, BOARD_SIZE - 1 - i, getTile(rotated, i, j));
+                mirrored = setTile(mirrored, i, BOARD_SIZE - 1 - j, getTile(rotated, i, j));
+            }
+        }
+        best = min(best, mirrored);
+        rotated = next;
+        best = min(best, rotated);
+    }
+    return best;
+}
+
+// Tốc độ đưa bàn cờ về dạng chuẩn theo 8 phép đối xứng, chạy trong mỗi lần tra bảng nhớ tạm
+static void benchSymmetry()
+{
+    vector<Board> boards = sampleBoards(4096);
+    const int rounds = 500;
+    double boardsCount = double(rounds) * boards.size();
+
+    uint64_t checksum = 0;
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            checksum += canonicalBoardByCells(boards[i] + round);
+        }
+    }
+    double cellMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            int transform;
+            checksum -= canonicalBoard(boards[i] + round, transform);
+        }
+    }
+    double bitMs = elapsedMs(start);
+
+    // Hai cách cho cùng kết quả thì checksum về 0
+    cout << "symmetry: per cell " << cellMs * 1e6 / boardsCount << " ns/board, bit-parallel "
+         << bitMs * 1e6 / boardsCount << " ns/board (checksum " << checksum << ")\n";
+}
+
+// Thông lượng expectimax với kernel bảng tra so với kernel vòng lặp từng ô và SIMD, có và không có bảng nhớ tạm.
+// Trong cây tìm kiếm các kernel phải tranh cache với bảng đánh giá và bảng nhớ tạm, khác với --bench moves.
+static void benchSearch()
+{
+    vector<Board> boards = sampleBoards(64);
+    TranspositionTable table(64);
+    heuristicTables();
+    const char *labels[] = {"table", "scalar", "simd", "table + tt", "simd + tt"};
+    const SearchKernel kernels[] = {SEARCH_TABLE, SEARCH_SCALAR, SEARCH_SIMD, SEARCH_TABLE, SEARCH_SIMD};
+    for (int k = 0; k < 5; ++k)
+    {
+        SearchLimits limits;
+        limits.depth = 3;
+        limits.kernel = kernels[k];
+        limits.table = k >= 3 ? &table : nullptr;
+        table.clear();
+        uint64_t nodes = 0;
+        double ms = 0;
+        uint64_t ttProbes = 0, ttHits = 0;
+        int checksum = 0;
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            SearchResult result = searchMove(boards[i], limits);
+            nodes += result.stats.nodes;
+            ms += result.stats.ms;
+            ttProbes += result.stats.ttProbes;
+            ttHits += result.stats.ttHits;
+            checksum += result.move;
+        }
+        cout << "search " << labels[k] << ": depth " << limits.depth << ", " << nodes << " nodes in " << ms << " ms, "
+             << nodes / ms / 1e3 << " M nodes/s";
+        if (limits.table)
+        {
+            cout << ", tt " << (table.memoryBytes() >> 20) << " MB hit rate " << 100.0 * ttHits / ttProbes << "%";
+        }
+        cout << " (checksum " << checksum << ")\n";
+    }
+}
+
+// Nhiều luồng cùng tìm trên một bảng nhớ tạm dùng chung không khóa: mỗi luồng lấy các bàn cờ
+// i % threads == t, nên luồng này được lợi từ mục do luồng khác ghi
+static void benchSharedTable()
+{
+    vector<Board> boards = sampleBoards(512);
+    TranspositionTable table(256);
+    // Dựng bảng đánh giá trước, để lần dựng đầu không rơi vào thời gian đo
+    heuristicTables();
+    cout << "hardware threads: " << thread::hardware_concurrency() << "\n";
+    for (int threads = 1; threads <= 32; threads *= 2)
+    {
+        table.clear();
+        table.newSearch();
+        vector<SearchStats> stats(threads);
+        Clock::time_point start = Clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.push_back(thread([&, t]() {
+                SearchLimits limits;
+                limits.depth = 3;
+                limits.table = &table;
+                SearchStats &total = stats[t];
+                total = SearchStats();
+                for (size_t i = t; i < boards.size(); i += threads)
+                {
+                    SearchResult result = searchMove(boards[i], limits);
+                    total.nodes += result.stats.nodes;
+                    total.ttProbes += result.stats.ttProbes;
+                    total.ttHits += result.stats.ttHits;
+                }
+            }));
+        }
+        for (thread &worker : workers)
+        {
+            worker.join();
+        }
+        double ms = elapsedMs(start);
+
+        uint64_t nodes = 0, probes = 0, hits = 0;
+        for (const SearchStats &s : stats)
+        {
+            nodes += s.nodes;
+            probes += s.ttProbes;
+            hits += s.ttHits;
+        }
+        cout << "shared tt " << threads << " threads: " << nodes / ms / 1e3 << " M nodes/s, hit rate "
+             << 100.0 * hits / probes << "%, " << ms << " ms\n";
+    }
+}
+
+// Tăng tốc của expectimax song song theo số luồng so với 1 luồng, cùng bảng nhớ tạm dùng chung
+static void benchParallel()
+{
+    vector<Board> boards = sampleBoards(16);
+    TranspositionTable table(256);
+    heuristicTables();
+    cout << "hardware threads: " << thread::hardware_concurrency() << "\n";
+    double baseMs = 0;
+    for (int threads = 1; threads <= 32; threads *= 2)
+    {
+        WorkPool pool(threads);
+        table.clear();
+        SearchLimits limits;
+        limits.depth = 4;
+        limits.table = &table;
+        limits.pool = &pool;
+        uint64_t nodes = 0;
+        int checksum = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            SearchResult result = searchMove(boards[i], limits);
+            nodes += result.stats.nodes;
+            checksum += result.move;
+        }
+        double ms = elapsedMs(start);
+        baseMs = threads == 1 ? ms : baseMs;
+        cout << "parallel " << threads << " threads: " << ms << " ms, " << nodes / ms / 1e3 << " M nodes/s, speedup "
+             << baseMs / ms << "x (checksum " << checksum << ")\n";
+    }
+}
+
+// Đường cong điểm theo số nút khi cắt nhánh xác suất thấp và lấy mẫu ô trống ở nút chance:
+// mỗi cấu hình tự chơi vài ván cùng seed, in điểm trung bình và số nút trung bình mỗi nước
+static void benchPruning()
+{
+    const float cutoffs[] = {0, 0.001f, 0.01f, 0.03f};
+    const int samples[] = {0, 4};
+    const int games = 2;
+    TranspositionTable table(64);
+    for (int sample : samples)
+    {
+        for (float cutoff : cutoffs)
+        {
+            table.clear();
+            SearchLimits limits;
+            limits.depth = 4;
+            limits.table = &table;
+            limits.minProbability = cutoff;
+            limits.maxSamples = sample;
+            HeadlessSummary summary = playHeadless(games, 2048, limits, false);
+            cout << "pruning cutoff " << cutoff << ", samples " << sample << ": average score " << summary.averageScore
+                 << ", " << double(summary.nodes) / summary.moves << " nodes/move, "
+                 << summary.ms / summary.moves << " ms/move\n";
+        }
+    }
+}
+
+// Người chơi giả nghĩ thinkMs rồi đi theo gợi ý: tỉ lệ bàn cờ mới đã được tìm sẵn
+// và thời gian từ lúc có bàn cờ mới tới lúc có gợi ý, so với không ponder
+static void benchPonder()
+{
+    const int thinkMs[] = {0, 20, 100};
+    const int moves = 30;
+    TranspositionTable table(64);
+    heuristicTables();
+    for (int ponder = 0; ponder <= 1; ++ponder)
+    {
+        for (int think : thinkMs)
+        {
+            table.clear();
+            SearchLimits limits;
+            limits.depth = 4;
+            limits.table = &table;
+            Advisor advisor(limits, ponder != 0);
+            Rng rng = makeRng(2048);
+            Board board = 0;
+            spawnTile(board, rng);
+            spawnTile(board, rng);
+            double waitMs = 0;
+            int played = 0;
+            for (; played < moves; ++played)
+            {
+                Clock::time_point start = Clock::now();
+                advisor.start(board);
+                int move;
+                while (!advisor.result(board, move))
+                {
+                    this_thread::yield();
+                }
+                waitMs += elapsedMs(start);
+                if (move < 0)
+                {
+                    break;
+                }
+                this_thread::sleep_for(chrono::milliseconds(think));
+                int gain;
+                moveBoardTable(board, Direction(move), gain);
+                spawnTile(board, rng);
+            }
+            cout << "ponder " << (ponder ? "on" : "off") << ", think " << think << " ms: hint after " << waitMs / max(played, 1)
+                 << " ms/move";
+            if (ponder)
+            {
+                cout << ", hit rate " << (advisor.ponderLookups() ? 100.0 * advisor.ponderHits() / advisor.ponderLookups() : 0)
+                     << "%";
+            }
+            cout << "\n";
+        }
+    }
+}
+
+// Đánh giá bàn cờ theo từng ô so với 8 lần tra bảng
+static void benchHeuristic()
+{
+    vector<Board> boards = sampleBoards(4096);
+    const HeuristicWeights &weights = heuristicWeights();
+    const HeuristicTables &tables = heuristicTables();
+
+    const int cellRounds = 20;
+    double checksum = 0;
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < cellRounds; ++round)
+    {
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            Board transposed = transposeBoard(boards[i]);
+            for (int l = 0; l < BOARD_SIZE; ++l)
+            {
+                checksum += evaluateLine(uint16_t(boards[i] >> (16 * l)), weights);
+                checksum += evaluateLine(uint16_t(transposed >> (16 * l)), weights);
+            }
+        }
+    }
+    double cellNs = elapsedMs(start) * 1e6 / (double(cellRounds) * boards.size());
+
+    const int tableRounds = 1000;
+    start = Clock::now();
+    for (int round = 0; round < tableRounds; ++round)
+    {
+        for (size_t i = 0; i < boards.size(); ++i)
+        {
+            checksum += tables.evaluate(boards[i]);
+        }
+    }
+    double tableNs = elapsedMs(start) * 1e6 / (double(tableRounds) * boards.size());
+
+    start = Clock::now();
+    unique_ptr<HeuristicTables> rebuilt(new HeuristicTables);
+    rebuilt->build(weights);
+    double buildMs = elapsedMs(start);
+
+    cout << "heuristic: per cell " << cellNs << " ns/board, tables " << tableNs << " ns/board, rebuild "
+         << buildMs << " ms (checksum " << checksum << ")\n";
+}
+
+bool runBenchmark(const char *name)
+{
+    if (strcmp(name, "startup") == 0)
+    {
+        benchStartup();
+        return true;
+    }
+    if (strcmp(name, "rng") == 0)
+    {
+        benchRng();
+        return true;
+    }
+    if (strcmp(name, "moves") == 0)
+    {
+        benchMoves();
+        return true;
+    }
+    if (strcmp(name, "batch") == 0)
+    {
+        benchBatch();
+        return true;
+    }
+    if (strcmp(name, "symmetry") == 0)
+    {
+        benchSymmetry();
+        return true;
+    }
+    if (strcmp(name, "heuristic") == 0)
+    {
+        benchHeuristic();
+        return true;
+    }
+    if (strcmp(name, "tt-threads") == 0)
+    {
+        benchSharedTable();
+        return true;
+    }
+    if (strcmp(name, "pruning") == 0)
+    {
+        benchPruning();
+        return true;
+    }
+    if (strcmp(name, "parallel") == 0)
+    {
+        benchParallel();
+        return true;
+    }
+    if (strcmp(name, "search") == 0)
+    {
+        benchSearch();
+        return true;
+    }
+    if (strcmp(name, "ponder") == 0)
+    {
+        benchPonder();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,120 @@
+#include "board.h"
+
+// Chỉ số ô thứ k trên đường thứ l, đường được đọc theo chiều di chuyển
+static int lineCell(Direction dir, int l, int k)
+{
+    switch (dir)
+    {
+    case DIR_UP:
+        return k * BOARD_SIZE + l;
+    case DIR_DOWN:
+        return (BOARD_SIZE - 1 - k) * BOARD_SIZE + l;
+    case DIR_LEFT:
+        return l * BOARD_SIZE + k;
+    default:
+        return l * BOARD_SIZE + (BOARD_SIZE - 1 - k);
+    }
+}
+
+bool moveBoard(Board &board, Direction dir, int &scoreGain, MoveResult *result)
+{
+    bool moved = false;
+    Board next = board;
+    scoreGain = 0;
+
+    if (result)
+    {
+        result->reset();
+    }
+
+    for (int l = 0; l < BOARD_SIZE; ++l)
+    {
+        int cells[BOARD_SIZE];
+        int before[BOARD_SIZE];
+        int line[BOARD_SIZE];
+        int to[BOARD_SIZE];
+        for (int k = 0; k < BOARD_SIZE; ++k)
+        {
+            cells[k] = lineCell(dir, l, k);
+            line[k] = before[k] = (board >> (4 * cells[k])) & 0xF;
+        }
+
+        if (!slideLine<BOARD_SIZE>(line, to, scoreGain))
+        {
+            continue;
+        }
+        moved = true;
+
+        for (int k = 0; k < BOARD_SIZE; ++k)
+        {
+            next = (next & ~(Board(0xF) << (4 * cells[k]))) | (Board(line[k]) << (4 * cells[k]));
+            if (result && to[k] != k)
+            {
+                result->add(cells[k], cells[to[k]]);
+            }
+        }
+        if (result)
+        {
+            int merges = lineMerges<BOARD_SIZE>(before, to);
+            for (int k = 0; k < BOARD_SIZE; ++k)
+            {
+                result->mergeMask |= uint64_t((merges >> k) & 1) << cells[k];
+            }
+        }
+    }
+
+    if (result)
+    {
+        result->moved = moved;
+        result->scoreGain = scoreGain;
+        result->markMerges();
+    }
+    board = next;
+    return moved;
+}
+
+bool canMoveBoard(Board board)
+{
+    if (emptyMask(board))
+    {
+        return true;
+    }
+    // Hai ô kề nhau bằng nhau cho một nibble 0 sau phép XOR với bàn cờ đã dịch; ô 32768 không gộp được
+    Board mergeable = ~emptyMask(~board);
+    Board horizontal = emptyMask(board ^ (board >> 4)) & mergeable & 0x0111011101110111ULL;
+    Board vertical = emptyMask(board ^ (board >> 16)) & mergeable & 0x0000111111111111ULL;
+    return (horizontal | vertical) != 0;
+}
+
+int legalMoves(Board board)
+{
+    // Một hướng hợp lệ khi có ô trống đứng trước một ô có số theo chiều đi, hoặc hai ô kề nhau gộp được
+    const Board firstThreeCols = 0x0111011101110111ULL;
+    const Board firstThreeRows = 0x0000111111111111ULL;
+    Board empty = emptyMask(board);
+    Board tiles = ~empty & 0x1111111111111111ULL;
+    Board mergeable = tiles & ~emptyMask(~board);
+    Board rowPairs = emptyMask(board ^ (board >> 4)) & mergeable & firstThreeCols;
+    Board columnPairs = emptyMask(board ^ (board >> 16)) & mergeable & firstThreeRows;
+
+    int mask = 0;
+    mask |= (((empty & (tiles >> 16)) & firstThreeRows) | columnPairs) ? 1 << DIR_UP : 0;
+    mask |= (((tiles & (empty >> 16)) & firstThreeRows) | columnPairs) ? 1 << DIR_DOWN : 0;
+    mask |= (((empty & (tiles >> 4)) & firstThreeCols) | rowPairs) ? 1 << DIR_LEFT : 0;
+    mask |= (((tiles & (empty >> 4)) & firstThreeCols) | rowPairs) ? 1 << DIR_RIGHT : 0;
+    return mask;
+}
+
+int maxTile(Board board)
+{
+    int best = 0;
+    for (int c = 0; c < BOARD_CELLS; ++c)
+    {
+        int exponent = (board >> (4 * c)) & 0xF;
+        if (exponent > best)
+        {
+            best = exponent;
+        }
+    }
+    return best;
+}
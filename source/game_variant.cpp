@@ -0,0 +1,22 @@
+#include "game_variant.h"
+
+GameVariant *createGameVariant(int size)
+{
+    switch (size)
+    {
+    case 3:
+        return new EscapeVariant<3, 3>();
+    case 4:
+        return new EscapeVariant<4, 4>();
+    case 5:
+        return new EscapeVariant<5, 5>();
+    case 6:
+        return new EscapeVariant<6, 6>();
+    case 7:
+        return new EscapeVariant<7, 7>();
+    case 8:
+        return new EscapeVariant<8, 8>();
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,151 @@
+#include "heuristic.h"
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+using namespace std;
+
+// Tên trong file trọng số và trường tương ứng
+struct WeightField
+{
+    const char *name;
+    float HeuristicWeights::*field;
+};
+
+static const WeightField WEIGHT_FIELDS[] = {
+    {"base", &HeuristicWeights::base},
+    {"empty", &HeuristicWeights::empty},
+    {"merges", &HeuristicWeights::merges},
+    {"monotonicity", &HeuristicWeights::monotonicity},
+    {"monotonicityPower", &HeuristicWeights::monotonicityPower},
+    {"sum", &HeuristicWeights::sum},
+    {"sumPower", &HeuristicWeights::sumPower},
+};
+
+bool loadHeuristicWeights(const char *path, HeuristicWeights &weights)
+{
+    ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    HeuristicWeights loaded = weights;
+    string line;
+    while (getline(file, line))
+    {
+        istringstream fields(line);
+        string name;
+        float value;
+        if (!(fields >> name) || name[0] == '#')
+        {
+            continue;
+        }
+        const WeightField *match = nullptr;
+        for (const WeightField &field : WEIGHT_FIELDS)
+        {
+            if (name == field.name)
+            {
+                match = &field;
+            }
+        }
+        if (!match || !(fields >> value))
+        {
+            return false;
+        }
+        loaded.*(match->field) = value;
+    }
+    weights = loaded;
+    return true;
+}
+
+// Thưởng ô trống và cặp sắp gộp, phạt hàng không đơn điệu và tổng các ô lớn
+// (để giữ ô lớn ít và dồn về một phía)
+float evaluateLine(uint16_t row, const HeuristicWeights &weights)
+{
+    int line[BOARD_SIZE];
+    for (int k = 0; k < BOARD_SIZE; ++k)
+    {
+        line[k] = (row >> (4 * k)) & 0xF;
+    }
+
+    float sum = 0;
+    int empty = 0, merges = 0;
+    int previous = 0, counter = 0;
+    for (int k = 0; k < BOARD_SIZE; ++k)
+    {
+        sum += pow(line[k], weights.sumPower);
+        if (line[k] == 0)
+        {
+            empty++;
+            continue;
+        }
+        if (previous == line[k])
+        {
+            counter++;
+        }
+        else if (counter > 0)
+        {
+            merges += 1 + counter;
+            counter = 0;
+        }
+        previous = line[k];
+    }
+    if (counter > 0)
+    {
+        merges += 1 + counter;
+    }
+
+    float left = 0, right = 0;
+    for (int k = 1; k < BOARD_SIZE; ++k)
+    {
+        float a = pow(line[k - 1], weights.monotonicityPower), b = pow(line[k], weights.monotonicityPower);
+        if (line[k - 1] > line[k])
+        {
+            left += a - b;
+        }
+        else
+        {
+            right += b - a;
+        }
+    }
+
+    return weights.base + weights.empty * empty + weights.merges * merges -
+           weights.monotonicity * (left < right ? left : right) - weights.sum * sum;
+}
+
+void HeuristicTables::build(const HeuristicWeights &weights)
+{
+    for (int row = 0; row < ROW_COUNT; ++row)
+    {
+        line[row] = evaluateLine(uint16_t(row), weights);
+    }
+}
+
+static HeuristicWeights sharedWeights;
+static HeuristicTables sharedTables;
+static once_flag sharedBuilt; // nhiều luồng tìm kiếm có thể cùng gọi heuristicTables() lần đầu
+
+static void buildSharedTables()
+{
+    sharedTables.build(sharedWeights);
+}
+
+const HeuristicTables &heuristicTables()
+{
+    call_once(sharedBuilt, buildSharedTables);
+    return sharedTables;
+}
+
+void setHeuristicWeights(const HeuristicWeights &weights)
+{
+    // Đánh dấu đã dựng trước để heuristicTables() không dựng lại bằng trọng số mặc định
+    call_once(sharedBuilt, [] {});
+    sharedWeights = weights;
+    sharedTables.build(sharedWeights);
+}
+
+const HeuristicWeights &heuristicWeights()
+{
+    return sharedWeights;
+}
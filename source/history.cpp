@@ -0,0 +1,82 @@
+#include "history.h"
+
+History::History(int capacity, int boardWords, int wideWords)
+    : capacity_(capacity), boardWords_(boardWords), wideWords_(wideWords),
+      boards_(std::size_t(capacity) * boardWords), scores_(capacity),
+      checkpoints_(capacity / CHECKPOINT_INTERVAL + 2),
+      current_(0), newest_(0)
+{
+}
+
+long long History::oldest() const
+{
+    return newest_ - capacity_ + 1 > 0 ? newest_ - capacity_ + 1 : 0;
+}
+
+void History::reset(const uint64_t *board, bool wide, int score, const Rng &rng)
+{
+    current_ = newest_ = -1;
+    push(board, wide, score, rng);
+}
+
+void History::push(const uint64_t *board, bool wide, int score, const Rng &rng)
+{
+    current_ = newest_ = current_ + 1;
+    std::size_t slot = std::size_t(current_ % capacity_);
+    if (wide && wideBoards_.empty())
+    {
+        wideBoards_.resize(std::size_t(capacity_) * wideWords_);
+    }
+    int words = wide ? wideWords_ : boardWords_;
+    uint64_t *record = (wide ? wideBoards_.data() : boards_.data()) + slot * words;
+    for (int w = 0; w < words; ++w)
+    {
+        record[w] = board[w];
+    }
+    scores_[slot] = uint32_t(score) | (wide ? WIDE_RECORD : 0);
+    if (current_ % CHECKPOINT_INTERVAL == 0)
+    {
+        checkpoints_[(current_ / CHECKPOINT_INTERVAL) % checkpoints_.size()] = rng;
+    }
+}
+
+void History::restore(long long move, uint64_t *board, bool &wide, int &score, int &moveCount, Rng &rng) const
+{
+    std::size_t slot = std::size_t(move % capacity_);
+    wide = (scores_[slot] & WIDE_RECORD) != 0;
+    int words = wide ? wideWords_ : boardWords_;
+    const uint64_t *record = (wide ? wideBoards_.data() : boards_.data()) + slot * words;
+    for (int w = 0; w < words; ++w)
+    {
+        board[w] = record[w];
+    }
+    score = int(scores_[slot] & ~WIDE_RECORD);
+    moveCount = int(move);
+
+    long long checkpoint = move - move % CHECKPOINT_INTERVAL;
+    rng = checkpoints_[(checkpoint / CHECKPOINT_INTERVAL) % checkpoints_.size()];
+    for (long long draw = checkpoint; draw < move; ++draw)
+    {
+        randomNext(rng);
+    }
+}
+
+bool History::undo(uint64_t *board, bool &wide, int &score, int &moveCount, Rng &rng)
+{
+    if (current_ <= oldest())
+    {
+        return false;
+    }
+    restore(--current_, board, wide, score, moveCount, rng);
+    return true;
+}
+
+bool History::redo(uint64_t *board, bool &wide, int &score, int &moveCount, Rng &rng)
+{
+    if (current_ >= newest_)
+    {
+        return false;
+    }
+    restore(++current_, board, wide, score, moveCount, rng);
+    return true;
+}
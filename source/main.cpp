@@ -5,26 +5,53 @@
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
+#include <cstring>
+#include "game_variant.h"
+#include "bench.h"
+#include "history.h"
+#include "ai.h"
+#include "advisor.h"
+#include "heuristic.h"
+#include "transposition.h"
+#include "work_pool.h"
+#include <thread>
 using namespace std;
 
 const int WINDOW_WIDTH = 400;
 const int WINDOW_HEIGHT = 450; 
-const int GRID_SIZE = 4;
-const int CELL_SIZE = WINDOW_WIDTH / GRID_SIZE;
 const int ANIMATION_SPEED = 10; 
 
 SDL_Window *window = nullptr;
 SDL_Renderer *renderer = nullptr;
 TTF_Font *font = nullptr;
 
-vector<vector<int>> grid(GRID_SIZE, vector<int>(GRID_SIZE, 0));
-vector<vector<pair<int, int>>> animationGrid(GRID_SIZE, vector<pair<int, int>>(GRID_SIZE, {0, 0}));
+int gridSize = 4; // Đổi bằng tham số dòng lệnh --size N
+int cellSize = WINDOW_WIDTH / gridSize;
+
+GameVariant *game = nullptr;
+Rng gameRng;
+uint64_t gameSeed = 0; // --seed N để chơi lại đúng một ván
+pair<int, int> animationGrid[MAX_GRID_SIZE][MAX_GRID_SIZE]; // Độ lệch vẽ của ô so với vị trí của nó
 
 bool gameOver = false;
 bool gameWon = false;
 bool gameStarted = false;
 int moveCount = 0;
 int score = 0;
+bool selfCheck = false; // --self-check: so trạng thái cập nhật dần với quét toàn bộ sau mỗi nước
+
+int historyCapacity = 65536; // --history N: số nước có thể undo
+History *history = nullptr;
+bool autoPlay = false; // phím A bật/tắt máy tự chơi (chỉ bàn 4x4)
+bool showHint = false; // phím H bật/tắt mũi tên gợi ý nước đi (chỉ bàn 4x4)
+Advisor *advisor = nullptr; // luồng AI tìm nước cho gợi ý và máy tự chơi
+bool ponderMode = false;    // --ponder: tìm sẵn mọi bàn cờ kế tiếp trong lúc người chơi nghĩ, bật sẵn gợi ý
+SearchLimits aiLimits;  // --ai-depth D, --ai-nodes N, --ai-cutoff P, --ai-samples K, --move-ms T, --ai-kernel K
+const int TIMED_DEPTH = 12; // độ sâu tối đa của tìm sâu dần khi có --move-ms mà không có --ai-depth
+int searchThreads = 0;               // --threads N: số luồng tìm kiếm, 0 là theo số lõi
+size_t ttMegabytes = 64;            // --tt-mb N: bảng nhớ tạm cho AI, 0 là tắt
+const char *weightsPath = nullptr; // --weights file: trọng số đánh giá, phím W đọc lại khi đang chơi
+uint64_t packedBoard[PackedGrid<MAX_GRID_SIZE, MAX_GRID_SIZE, WIDE_CELL_BITS>::WORDS];
 
 // Khởi tạo SDL và TTF
 void initialize()
@@ -82,20 +109,79 @@ void drawStartScreen()
     SDL_RenderPresent(renderer);
 }
 
+// Chữ trên ô: giá trị đầy đủ tới 2^63 (20 ký tự), lớn hơn thì ghi dạng 2^e
+const int TILE_TEXT_SIZE = 24;
+
+void formatTile(char *buffer, size_t size, int exponent)
+{
+    if (exponent < 64)
+    {
+        snprintf(buffer, size, "%llu", 1ULL << exponent);
+    }
+    else
+    {
+        snprintf(buffer, size, "2^%d", exponent);
+    }
+}
+
+// Bàn cờ hiện tại dạng 64 bit cho AI; false nếu không phải 4x4 hoặc có ô vượt quá 32768
+bool currentBoard(Board &board)
+{
+    if (gridSize != BOARD_SIZE)
+    {
+        return false;
+    }
+    board = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i)
+    {
+        for (int j = 0; j < BOARD_SIZE; ++j)
+        {
+            int exponent = game->getTile(i, j);
+            if (exponent > MAX_EXPONENT)
+            {
+                return false;
+            }
+            board = setTile(board, i, j, exponent);
+        }
+    }
+    return true;
+}
+
+// Mũi tên gợi ý giữa bộ đếm nước và điểm số
+void drawHintArrow(Direction dir)
+{
+    const int centerX = WINDOW_WIDTH / 2 - 10, centerY = 27, length = 15, head = 7;
+    static const int DX[4] = {0, 0, -1, 1}; // theo thứ tự Direction: lên, xuống, trái, phải
+    static const int DY[4] = {-1, 1, 0, 0};
+    int dx = DX[dir], dy = DY[dir];
+    int tipX = centerX + dx * length, tipY = centerY + dy * length;
+    SDL_SetRenderDrawColor(renderer, 119, 110, 101, 255);
+    for (int w = -1; w <= 1; ++w)
+    {
+        // (dy, dx) vuông góc với mũi tên: dịch nét sang hai bên cho dày 3 pixel
+        int ox = dy * w, oy = dx * w;
+        SDL_RenderDrawLine(renderer, centerX - dx * length + ox, centerY - dy * length + oy, tipX + ox, tipY + oy);
+        SDL_RenderDrawLine(renderer, tipX + ox, tipY + oy, tipX - dx * head + dy * head + ox, tipY - dy * head + dx * head + oy);
+        SDL_RenderDrawLine(renderer, tipX + ox, tipY + oy, tipX - dx * head - dy * head + ox, tipY - dy * head - dx * head + oy);
+    }
+}
+
 // Khởi tạo ô 4x4 với 2 ô 1x1 chứa số ngẫu nhiên
 void drawGrid()
 {
     SDL_SetRenderDrawColor(renderer, 187, 173, 160, 255); //Chọn màu nền trong trò chơi
     SDL_RenderClear(renderer);
 
-    for (int i = 0; i < GRID_SIZE; ++i)
+    for (int i = 0; i < gridSize; ++i)
     {
-        for (int j = 0; j < GRID_SIZE; ++j)
+        for (int j = 0; j < gridSize; ++j)
         {
-            SDL_Rect cellRect = {j * CELL_SIZE + 5, i * CELL_SIZE + 55, CELL_SIZE - 10, CELL_SIZE - 10}; // Điều chỉnh vị trí y cho bộ đếm di chuyển và điểm số
+            SDL_Rect cellRect = {j * cellSize + 5, i * cellSize + 55, cellSize - 10, cellSize - 10}; // Điều chỉnh vị trí y cho bộ đếm di chuyển và điểm số
+
+            int exponent = game->getTile(i, j);
 
            // Đặt màu dựa trên việc ô có số hay không
-            if (grid[i][j] == 0)
+            if (exponent == 0)
             {
                 SDL_SetRenderDrawColor(renderer, 205, 193, 180, 255); // Màu sáng cho ô trống
             }
@@ -105,15 +191,15 @@ void drawGrid()
             }
             SDL_RenderFillRect(renderer, &cellRect);
 
-            if (grid[i][j] != 0)
+            if (exponent != 0)
             {
                 SDL_Color textColor = {119, 110, 101, 255};
-                char buffer[10];
-                snprintf(buffer, sizeof(buffer), "%d", grid[i][j]);
+                char buffer[TILE_TEXT_SIZE];
+                formatTile(buffer, sizeof(buffer), exponent);
                 int textWidth, textHeight;
                 TTF_SizeText(font, buffer, &textWidth, &textHeight);
-                int x = j * CELL_SIZE + (CELL_SIZE - textWidth) / 2 + animationGrid[i][j].first;
-                int y = i * CELL_SIZE + (CELL_SIZE - textHeight) / 2 + animationGrid[i][j].second + 55; // Điều chỉnh vị trí y cho bộ đếm di chuyển và điểm số
+                int x = j * cellSize + (cellSize - textWidth) / 2 + animationGrid[i][j].first;
+                int y = i * cellSize + (cellSize - textHeight) / 2 + animationGrid[i][j].second + 55; // Điều chỉnh vị trí y cho bộ đếm di chuyển và điểm số
                 drawText(buffer, x, y, textColor);
             }
         }
@@ -130,6 +216,14 @@ void drawGrid()
     snprintf(scoreBuffer, sizeof(scoreBuffer), "Score: %d", score);
     drawText(scoreBuffer, WINDOW_WIDTH - 150, 15, textColor);
 
+    // Chỉ vẽ khi luồng AI đã tìm xong cho đúng bàn cờ đang hiện, không bao giờ chờ
+    Board board;
+    int hint;
+    if (showHint && currentBoard(board) && advisor->result(board, hint) && hint >= 0)
+    {
+        drawHintArrow(Direction(hint));
+    }
+
     if (gameOver)
     {
         // Hiển thị lớp phủ đen bán trong suốt
@@ -162,164 +256,87 @@ void drawGrid()
 // Tạo thêm ô chứa số ngẫu nhiên
 void addRandomTile()
 {
-   vector<pair<int, int>> emptyCells;
-    for (int i = 0; i < GRID_SIZE; ++i)
-    {
-        for (int j = 0; j < GRID_SIZE; ++j)
-        {
-            if (grid[i][j] == 0)
-            {
-                emptyCells.push_back({i, j});
-            }
-        }
-    }
-
-    if (!emptyCells.empty())
-    {
-        int index = rand() % emptyCells.size();
-        int value = (rand() % 10) < 9 ? 2 : 4;
-        grid[emptyCells[index].first][emptyCells[index].second] = value;
-    }
+    game->spawn(gameRng);
 }
 
 // Kiểm tra xem có thể di chuyển ô hay không
 bool canMove()
 {
-    for (int i = 0; i < GRID_SIZE; ++i)
+    return game->hasMove();
+}
+
+// Giao bàn cờ hiện tại cho luồng AI khi cần gợi ý hoặc tự chơi; start() bỏ qua nếu bàn cờ không đổi
+void adviseCurrentBoard()
+{
+    Board board;
+    if ((showHint || autoPlay) && gameStarted && !gameOver && !gameWon && currentBoard(board))
     {
-        for (int j = 0; j < GRID_SIZE; ++j)
-        {
-            if (grid[i][j] == 0)
-            {
-                return true;
-            }
-            if (i < GRID_SIZE - 1 && grid[i][j] == grid[i + 1][j])
-            {
-                return true;
-            }
-            if (j < GRID_SIZE - 1 && grid[i][j] == grid[i][j + 1])
-            {
-                return true;
-            }
-        }
+        advisor->start(board);
     }
-    return false;
 }
 
 // Di chuyển ô
-void moveTiles(int dx, int dy)
+void moveTiles(Direction dir)
 {
-    bool moved = false;
-    vector<vector<int>> newGrid = grid;
-    vector<vector<pair<int, int>>> newAnimationGrid = animationGrid;
+    MoveResult result;
+    int scoreGain = 0;
 
-    if (dx != 0)
+    if (game->move(dir, scoreGain, &result))
     {
-        for (int i = 0; i < GRID_SIZE; ++i)
+        score += scoreGain; // Cập nhật điểm
+
+        // Ô ở vị trí đích bắt đầu vẽ từ ô nguồn rồi trượt về; khi gộp lấy ô đi xa nhất
+        for (int i = 0; i < gridSize; ++i)
         {
-            for (int j = (dx == 1 ? GRID_SIZE - 2 : 1); (dx == 1 ? j >= 0 : j < GRID_SIZE); j -= dx)
+            for (int j = 0; j < gridSize; ++j)
             {
-                if (newGrid[i][j] != 0)
-                {
-                    int x = j + dx;
-                    while (x >= 0 && x < GRID_SIZE && newGrid[i][x] == 0)
-                    {
-                        x += dx;
-                    }
-                    if (x >= 0 && x < GRID_SIZE && newGrid[i][x] == newGrid[i][j])
-                    {
-                        newGrid[i][x] *= 2;
-                        score += newGrid[i][x]; // Cập nhật điểm 
-                        newGrid[i][j] = 0;
-                        newAnimationGrid[i][j] = {(x - j) * CELL_SIZE, 0};
-                        moved = true;
-                    }
-                    else
-                    {
-                        x -= dx;
-                        if (x != j)
-                        {
-                            newGrid[i][x] = newGrid[i][j];
-                            newGrid[i][j] = 0;
-                            newAnimationGrid[i][j] = {(x - j) * CELL_SIZE, 0};
-                            moved = true;
-                        }
-                    }
-                }
+                animationGrid[i][j] = {0, 0};
             }
         }
-    }
-    else if (dy != 0)
-    {
-        for (int j = 0; j < GRID_SIZE; ++j)
+        for (int t = 0; t < result.count; ++t)
         {
-            for (int i = (dy == 1 ? GRID_SIZE - 2 : 1); (dy == 1 ? i >= 0 : i < GRID_SIZE); i -= dy)
+            const Trajectory &trajectory = result.trajectories[t];
+            int i = trajectory.to / gridSize, j = trajectory.to % gridSize;
+            int offsetX = (trajectory.from % gridSize - j) * cellSize;
+            int offsetY = (trajectory.from / gridSize - i) * cellSize;
+            if (abs(offsetX) + abs(offsetY) > abs(animationGrid[i][j].first) + abs(animationGrid[i][j].second))
             {
-                if (newGrid[i][j] != 0)
-                {
-                    int y = i + dy;
-                    while (y >= 0 && y < GRID_SIZE && newGrid[y][j] == 0)
-                    {
-                        y += dy;
-                    }
-                    if (y >= 0 && y < GRID_SIZE && newGrid[y][j] == newGrid[i][j])
-                    {
-                        newGrid[y][j] *= 2;
-                        score += newGrid[y][j]; // Câp nhật điểm
-                        newGrid[i][j] = 0;
-                        newAnimationGrid[i][j] = {0, (y - i) * CELL_SIZE};
-                        moved = true;
-                    }
-                    else
-                    {
-                        y -= dy;
-                        if (y != i)
-                        {
-                            newGrid[y][j] = newGrid[i][j];
-                            newGrid[i][j] = 0;
-                            newAnimationGrid[i][j] = {0, (y - i) * CELL_SIZE};
-                            moved = true;
-                        }
-                    }
-                }
+                animationGrid[i][j] = {offsetX, offsetY};
             }
         }
-    }
-
-    if (moved)
-    {
-        grid = newGrid;
-        animationGrid = newAnimationGrid;
         addRandomTile();
         moveCount++;
+        game->savePacked(packedBoard);
+        history->push(packedBoard, game->packedWide(), score, gameRng);
+
+        if (selfCheck && !game->checkStatus())
+        {
+            cerr << "Incremental game status differs from full rescan after move " << moveCount << "\n";
+        }
 
         // Kiểm tra xem người chơi đã thắng chưa
-        for (int i = 0; i < GRID_SIZE; ++i)
+        if (game->won())
         {
-            for (int j = 0; j < GRID_SIZE; ++j)
-            {
-                if (grid[i][j] == 2048)
-                {
-                    gameWon = true;
-                    return;
-                }
-            }
+            gameWon = true;
+            return;
         }
 
         if (!canMove())
         {
             gameOver = true;
         }
+        // Tìm nước tiếp theo ngay khi nước này xong, song song với hoạt ảnh trượt ô
+        adviseCurrentBoard();
     }
 }
 
-// Cập nhật hoạt ảnh (gộp 2 ô)
-void updateAnimation()
+// Cập nhật hoạt ảnh (gộp 2 ô), trả về true nếu còn ô đang trượt
+bool updateAnimation()
 {
     bool animating = false;
-    for (int i = 0; i < GRID_SIZE; ++i)
+    for (int i = 0; i < gridSize; ++i)
     {
-        for (int j = 0; j < GRID_SIZE; ++j)
+        for (int j = 0; j < gridSize; ++j)
         {
             if (animationGrid[i][j].first != 0)
             {
@@ -348,11 +365,205 @@ void updateAnimation()
     {
         drawGrid();
     }
+    return animating;
+}
+
+// Đọc trọng số từ weightsPath và dựng lại bảng đánh giá.
+// Bảng đánh giá được dựng lại tại chỗ nên phải đợi luồng AI dừng hẳn; mọi giá trị đã tính
+// theo trọng số cũ (bảng nhớ tạm, gợi ý và ponder của luồng AI) đều bỏ.
+bool reloadWeights()
+{
+    HeuristicWeights weights = heuristicWeights();
+    if (!loadHeuristicWeights(weightsPath, weights))
+    {
+        cerr << "Failed to load heuristic weights from " << weightsPath << "\n";
+        return false;
+    }
+    if (advisor)
+    {
+        advisor->cancel();
+        advisor->wait();
+        advisor->forget();
+    }
+    if (aiLimits.table)
+    {
+        aiLimits.table->clear();
+    }
+    setHeuristicWeights(weights);
+    return true;
+}
+
+// Máy tự chơi một nước sau khi hoạt ảnh của nước trước đã xong; luồng AI chưa tìm xong thì đợi khung hình sau
+void autoPlayMove()
+{
+    Board board;
+    int move;
+    if (!currentBoard(board))
+    {
+        autoPlay = false;
+        return;
+    }
+    if (advisor->result(board, move) && move >= 0)
+    {
+        moveTiles(Direction(move));
+    }
+}
+
+// Undo (Z) hoặc redo (Y): nạp lại bàn cờ, điểm, số nước và rng rồi tính lại trạng thái thắng/thua
+void stepHistory(bool forward)
+{
+    bool wide = false;
+    bool changed = forward ? history->redo(packedBoard, wide, score, moveCount, gameRng)
+                           : history->undo(packedBoard, wide, score, moveCount, gameRng);
+    if (!changed)
+    {
+        return;
+    }
+    game->loadPacked(packedBoard, wide);
+    for (int i = 0; i < gridSize; ++i)
+    {
+        for (int j = 0; j < gridSize; ++j)
+        {
+            animationGrid[i][j] = {0, 0};
+        }
+    }
+    gameWon = game->won();
+    gameOver = !gameWon && !canMove();
 }
 
 int main(int argc, char *argv[])
 {
-    srand(time(0));
+    bool seedGiven = false;
+    bool depthGiven = false;
+    int headlessGames = 0;
+    for (int a = 1; a < argc; ++a)
+    {
+        bool hasValue = a + 1 < argc;
+        // Chạy benchmark không cần cửa sổ: game.exe --bench <tên>
+        if (strcmp(argv[a], "--bench") == 0 && hasValue)
+        {
+            if (!runBenchmark(argv[a + 1]))
+            {
+                cerr << "Unknown benchmark: " << argv[a + 1] << "\n";
+                return 1;
+            }
+            return 0;
+        }
+        // Chọn kích thước bàn cờ: game.exe --size 5
+        else if (strcmp(argv[a], "--size") == 0 && hasValue)
+        {
+            gridSize = atoi(argv[++a]);
+        }
+        else if (strcmp(argv[a], "--seed") == 0 && hasValue)
+        {
+            gameSeed = strtoull(argv[++a], nullptr, 10);
+            seedGiven = true;
+        }
+        else if (strcmp(argv[a], "--history") == 0 && hasValue)
+        {
+            historyCapacity = atoi(argv[++a]);
+        }
+        else if (strcmp(argv[a], "--ai-depth") == 0 && hasValue)
+        {
+            aiLimits.depth = atoi(argv[++a]);
+            depthGiven = true;
+        }
+        else if (strcmp(argv[a], "--ai-nodes") == 0 && hasValue)
+        {
+            aiLimits.nodeBudget = strtoull(argv[++a], nullptr, 10);
+        }
+        else if (strcmp(argv[a], "--ai-cutoff") == 0 && hasValue)
+        {
+            aiLimits.minProbability = atof(argv[++a]);
+        }
+        else if (strcmp(argv[a], "--ai-samples") == 0 && hasValue)
+        {
+            aiLimits.maxSamples = atoi(argv[++a]);
+        }
+        // Kernel di chuyển trong cây tìm kiếm: table (mặc định), simd hoặc scalar
+        else if (strcmp(argv[a], "--ai-kernel") == 0 && hasValue)
+        {
+            const char *kernel = argv[++a];
+            aiLimits.kernel = strcmp(kernel, "simd") == 0     ? SEARCH_SIMD
+                              : strcmp(kernel, "scalar") == 0 ? SEARCH_SCALAR
+                                                              : SEARCH_TABLE;
+        }
+        else if (strcmp(argv[a], "--move-ms") == 0 && hasValue)
+        {
+            aiLimits.moveMs = atof(argv[++a]);
+        }
+        // Máy tự chơi N ván 4x4 không cần cửa sổ: game.exe --ai-games 10
+        else if (strcmp(argv[a], "--ai-games") == 0 && hasValue)
+        {
+            headlessGames = atoi(argv[++a]);
+        }
+        else if (strcmp(argv[a], "--threads") == 0 && hasValue)
+        {
+            searchThreads = atoi(argv[++a]);
+        }
+        else if (strcmp(argv[a], "--tt-mb") == 0 && hasValue)
+        {
+            ttMegabytes = strtoull(argv[++a], nullptr, 10);
+        }
+        else if (strcmp(argv[a], "--weights") == 0 && hasValue)
+        {
+            weightsPath = argv[++a];
+        }
+        else if (strcmp(argv[a], "--ponder") == 0)
+        {
+            ponderMode = true;
+            showHint = true;
+        }
+        else if (strcmp(argv[a], "--self-check") == 0)
+        {
+            selfCheck = true;
+        }
+    }
+
+    if (!seedGiven)
+    {
+        gameSeed = time(0);
+    }
+    if (aiLimits.moveMs > 0 && !depthGiven)
+    {
+        aiLimits.depth = TIMED_DEPTH;
+    }
+    if (weightsPath && !reloadWeights())
+    {
+        return 1;
+    }
+    if (ttMegabytes > 0)
+    {
+        aiLimits.table = new TranspositionTable(ttMegabytes);
+    }
+    if (searchThreads <= 0)
+    {
+        searchThreads = thread::hardware_concurrency();
+    }
+    aiLimits.pool = new WorkPool(searchThreads);
+    if (headlessGames > 0)
+    {
+        playHeadless(headlessGames, gameSeed, aiLimits);
+        delete aiLimits.pool;
+        delete aiLimits.table;
+        return 0;
+    }
+
+    game = createGameVariant(gridSize);
+    if (!game)
+    {
+        cerr << "Unsupported grid size: " << gridSize << " (" << MIN_GRID_SIZE << "-" << MAX_GRID_SIZE << ")\n";
+        return 1;
+    }
+    cellSize = WINDOW_WIDTH / gridSize;
+    if (historyCapacity < 1)
+    {
+        historyCapacity = 1;
+    }
+    // Cấp phát lịch sử một lần; vòng bản ghi 8 bit chỉ cấp phát thêm một lần khi ván vượt ô 32768
+    history = new History(historyCapacity, game->packedWords(false), game->packedWords(true));
+    advisor = new Advisor(aiLimits, ponderMode);
+
     initialize();
 
     bool running = true;
@@ -362,6 +573,11 @@ int main(int argc, char *argv[])
     {
         while (SDL_PollEvent(&event))
         {
+            // Phím bấm làm kết quả đang tìm có thể lỗi thời; bàn cờ mới được giao lại ở cuối khung hình
+            if (event.type == SDL_KEYDOWN)
+            {
+                advisor->cancel();
+            }
             if (event.type == SDL_QUIT)
             {
                 running = false;
@@ -378,34 +594,71 @@ int main(int argc, char *argv[])
                     gameWon = false;
                     moveCount = 0;
                     score = 0;
-                    grid = vector<vector<int>>(GRID_SIZE, vector<int>(GRID_SIZE, 0));
+                    game->clear();
+                    gameRng = makeRng(gameSeed);
+                    cout << "Seed: " << gameSeed << "\n";
                     addRandomTile();
                     addRandomTile();
+                    game->savePacked(packedBoard);
+                    history->reset(packedBoard, game->packedWide(), score, gameRng);
                 }
             }
+            else if (event.type == SDL_KEYDOWN && gameStarted && event.key.keysym.sym == SDLK_a)
+            {
+                Board board;
+                autoPlay = !autoPlay && currentBoard(board);
+            }
+            else if (event.type == SDL_KEYDOWN && gameStarted && event.key.keysym.sym == SDLK_h)
+            {
+                Board board;
+                showHint = !showHint && currentBoard(board);
+            }
+            else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_w && weightsPath)
+            {
+                reloadWeights();
+            }
+            else if (event.type == SDL_KEYDOWN && gameStarted && (event.key.keysym.sym == SDLK_z || event.key.keysym.sym == SDLK_y))
+            {
+                // Undo/redo dùng được cả khi đã thắng hoặc thua
+                stepHistory(event.key.keysym.sym == SDLK_y);
+            }
             else if (event.type == SDL_KEYDOWN && gameStarted && !gameOver && !gameWon)
             {
+                Direction dir = DIR_UP;
+                bool arrowKey = true;
                 switch (event.key.keysym.sym)
                 {
                 case SDLK_UP:
-                    moveTiles(0, -1);
+                    dir = DIR_UP;
                     break;
                 case SDLK_DOWN:
-                    moveTiles(0, 1);
+                    dir = DIR_DOWN;
                     break;
                 case SDLK_LEFT:
-                    moveTiles(-1, 0);
+                    dir = DIR_LEFT;
                     break;
                 case SDLK_RIGHT:
-                    moveTiles(1, 0);
+                    dir = DIR_RIGHT;
                     break;
+                default:
+                    arrowKey = false;
+                    break;
+                }
+                // Bỏ qua phím không làm thay đổi bàn cờ mà không cần đi thử
+                if (arrowKey && (game->legalMoves() >> dir) & 1)
+                {
+                    moveTiles(dir);
                 }
             }
         }
 
         if (gameStarted)
         {
-            updateAnimation();
+            adviseCurrentBoard();
+            if (!updateAnimation() && autoPlay && !gameOver && !gameWon)
+            {
+                autoPlayMove();
+            }
             drawGrid();
         }
         else
@@ -415,5 +668,16 @@ int main(int argc, char *argv[])
     }
 
     close();
+    if (ponderMode)
+    {
+        uint64_t lookups = advisor->ponderLookups();
+        cout << "ponder: " << advisor->ponderHits() << " of " << lookups << " positions searched in advance, hit rate "
+             << (lookups ? 100.0 * advisor->ponderHits() / lookups : 0) << "%\n";
+    }
+    delete advisor;
+    delete aiLimits.pool;
+    delete aiLimits.table;
+    delete history;
+    delete game;
     return 0;
 }
\ No newline at end of file
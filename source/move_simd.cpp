@@ -0,0 +1,209 @@
+#include "move_simd.h"
+#include "move_table.h"
+#include <SDL2/SDL_cpuinfo.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MOVE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef MOVE_SIMD_X86
+
+#define SIMD_TARGET __attribute__((target("sse4.1")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// Mặt nạ pshufb đưa mỗi hướng về trượt trái (forward) và trả lại như cũ (inverse).
+// Hàng là một lane 32 bit, ô k của hàng nằm ở byte k của lane.
+alignas(16) static const int8_t forwardShuffle[4][16] = {
+    {0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15}, // lên: chuyển vị
+    {12, 8, 4, 0, 13, 9, 5, 1, 14, 10, 6, 2, 15, 11, 7, 3}, // xuống: chuyển vị rồi đảo hàng
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, // trái
+    {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12}, // phải: đảo hàng
+};
+alignas(16) static const int8_t inverseShuffle[4][16] = {
+    {0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15},
+    {3, 7, 11, 15, 2, 6, 10, 14, 1, 5, 9, 13, 0, 4, 8, 12},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+};
+
+// Bỏ một ô trống đầu tiên của mỗi hàng: mọi byte từ ô trống đó trở đi lấy giá trị ô bên phải
+SIMD_TARGET static inline __m128i dropFirstGap(__m128i cells, __m128i gaps)
+{
+    __m128i after = _mm_or_si128(_mm_or_si128(gaps, _mm_slli_epi32(gaps, 8)),
+                                 _mm_or_si128(_mm_slli_epi32(gaps, 16), _mm_slli_epi32(gaps, 24)));
+    return _mm_blendv_epi8(cells, _mm_srli_epi32(cells, 8), after);
+}
+
+// Trượt trái cả 4 hàng; scores nhận 2^số mũ của từng lần gộp theo lane
+SIMD_TARGET static inline __m128i slideRowsLeft(__m128i cells, __m128i &scores)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i maxExponent = _mm_set1_epi8(MAX_EXPONENT);
+
+    // Dồn các ô khác 0 về đầu hàng (tối đa 3 khoảng trống)
+    for (int round = 0; round < BOARD_SIZE - 1; ++round)
+    {
+        cells = dropFirstGap(cells, _mm_cmpeq_epi8(cells, zero));
+    }
+
+    // Ô đỉnh (cursor) gộp với ô kế tiếp nếu bằng nhau, giống luật slideLine nên có thể gộp nối tiếp
+    __m128i cursor = _mm_set1_epi32(0xFF);
+    for (int step = 0; step < BOARD_SIZE - 1; ++step)
+    {
+        __m128i next = _mm_srli_epi32(cells, 8);
+        __m128i merge = _mm_and_si128(_mm_cmpeq_epi8(cells, next), cursor);
+        merge = _mm_andnot_si128(_mm_cmpeq_epi8(next, zero), merge);
+        merge = _mm_andnot_si128(_mm_cmpeq_epi8(cells, maxExponent), merge);
+
+        cells = _mm_sub_epi8(cells, merge);
+        __m128i gain = _mm_and_si128(cells, merge);
+        cells = dropFirstGap(cells, _mm_slli_epi32(merge, 8));
+        cursor = _mm_blendv_epi8(_mm_slli_epi32(cursor, 8), cursor, merge);
+
+        // Mỗi lane có nhiều nhất một byte khác 0: gom về byte thấp rồi tính 2^e qua bit số mũ float
+        gain = _mm_or_si128(gain, _mm_srli_epi32(gain, 16));
+        gain = _mm_and_si128(_mm_or_si128(gain, _mm_srli_epi32(gain, 8)), _mm_set1_epi32(0xFF));
+        __m128i power = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(gain, _mm_set1_epi32(127)), 23)));
+        scores = _mm_add_epi32(scores, _mm_andnot_si128(_mm_cmpeq_epi32(gain, zero), power));
+    }
+    return cells;
+}
+
+SIMD_TARGET bool moveBoardSimd(Board &board, Direction dir, int &scoreGain)
+{
+    const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+    __m128i packed = _mm_loadl_epi64((const __m128i *)&board);
+    __m128i cells = _mm_unpacklo_epi8(_mm_and_si128(packed, lowNibbles),
+                                      _mm_and_si128(_mm_srli_epi16(packed, 4), lowNibbles));
+
+    cells = _mm_shuffle_epi8(cells, _mm_load_si128((const __m128i *)forwardShuffle[dir]));
+    __m128i scores = _mm_setzero_si128();
+    cells = slideRowsLeft(cells, scores);
+    cells = _mm_shuffle_epi8(cells, _mm_load_si128((const __m128i *)inverseShuffle[dir]));
+
+    // Gói lại: byte chẵn là nibble thấp, byte lẻ là nibble cao
+    cells = _mm_and_si128(_mm_or_si128(cells, _mm_srli_epi16(cells, 4)), _mm_set1_epi16(0xFF));
+    Board result;
+    _mm_storel_epi64((__m128i *)&result, _mm_packus_epi16(cells, cells));
+
+    scores = _mm_add_epi32(scores, _mm_shuffle_epi32(scores, _MM_SHUFFLE(1, 0, 3, 2)));
+    scores = _mm_add_epi32(scores, _mm_shuffle_epi32(scores, _MM_SHUFFLE(2, 3, 0, 1)));
+    scoreGain = _mm_cvtsi128_si32(scores);
+
+    bool moved = result != board;
+    board = result;
+    return moved;
+}
+
+// Chuyển vị 4 bàn cờ cùng lúc, từng bước như transposeBoard
+AVX2_TARGET static inline __m256i transposeBoards4(__m256i boards)
+{
+    __m256i a1 = _mm256_and_si256(boards, _mm256_set1_epi64x(0xF0F00F0FF0F00F0FLL));
+    __m256i a2 = _mm256_and_si256(boards, _mm256_set1_epi64x(0x0000F0F00000F0F0LL));
+    __m256i a3 = _mm256_and_si256(boards, _mm256_set1_epi64x(0x0F0F00000F0F0000LL));
+    __m256i a = _mm256_or_si256(a1, _mm256_or_si256(_mm256_slli_epi64(a2, 12), _mm256_srli_epi64(a3, 12)));
+    __m256i b1 = _mm256_and_si256(a, _mm256_set1_epi64x(0xFF00FF0000FF00FFLL));
+    __m256i b2 = _mm256_and_si256(a, _mm256_set1_epi64x(0x00FF00FF00000000LL));
+    __m256i b3 = _mm256_and_si256(a, _mm256_set1_epi64x(0x00000000FF00FF00LL));
+    return _mm256_or_si256(b1, _mm256_or_si256(_mm256_srli_epi64(b2, 24), _mm256_slli_epi64(b3, 24)));
+}
+
+// Tra 8 hàng (mỗi lane 32 bit một hàng) trong bảng trái hoặc phải tùy lane
+AVX2_TARGET static inline void gatherRows(__m256i rows, __m256i toRight, __m256i &results, __m256i &scores)
+{
+    const int *leftResult = (const int *)leftRowTables.result;
+    const int *rightResult = (const int *)rightRowTables.result;
+    __m256i toLeft = _mm256_xor_si256(toRight, _mm256_set1_epi32(-1));
+    // Đọc 32 bit ở result[row] rồi bỏ 16 bit cao; với row cuối, 2 byte thừa vẫn nằm trong RowTables
+    results = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), leftResult, rows, toLeft, 2);
+    results = _mm256_mask_i32gather_epi32(results, rightResult, rows, toRight, 2);
+    results = _mm256_and_si256(results, _mm256_set1_epi32(0xFFFF));
+    scores = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)leftRowTables.score, rows, toLeft, 4);
+    scores = _mm256_mask_i32gather_epi32(scores, (const int *)rightRowTables.score, rows, toRight, 4);
+}
+
+AVX2_TARGET void moveBoardsAvx2(const Board *boards, const uint8_t *dirs, Board *results, int *scoreGains)
+{
+    __m256i before = _mm256_loadu_si256((const __m256i *)boards);
+    uint32_t packedDirs;
+    memcpy(&packedDirs, dirs, sizeof(packedDirs));
+    __m256i dir = _mm256_and_si256(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(int(packedDirs))), _mm256_set1_epi64x(3));
+    // Lên/xuống (0, 1) đi qua chuyển vị; xuống/phải (1, 3) dùng bảng trượt phải
+    __m256i vertical = _mm256_cmpgt_epi64(_mm256_set1_epi64x(2), dir);
+    __m256i toRight = _mm256_cmpeq_epi64(_mm256_and_si256(dir, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1));
+
+    __m256i rows = _mm256_blendv_epi8(before, transposeBoards4(before), vertical);
+    // Lane 32 bit chẵn giữ hàng 0 và 1, lane lẻ giữ hàng 2 và 3 của cùng bàn cờ
+    __m256i evenResults, evenScores, oddResults, oddScores;
+    gatherRows(_mm256_and_si256(rows, _mm256_set1_epi32(0xFFFF)), toRight, evenResults, evenScores);
+    gatherRows(_mm256_srli_epi32(rows, 16), toRight, oddResults, oddScores);
+    __m256i after = _mm256_or_si256(evenResults, _mm256_slli_epi32(oddResults, 16));
+    after = _mm256_blendv_epi8(after, transposeBoards4(after), vertical);
+    _mm256_storeu_si256((__m256i *)results, after);
+
+    __m256i scores = _mm256_add_epi32(evenScores, oddScores);
+    scores = _mm256_add_epi32(scores, _mm256_srli_epi64(scores, 32));
+    alignas(32) int64_t gains[4];
+    _mm256_store_si256((__m256i *)gains, scores);
+    for (int i = 0; i < 4; ++i)
+    {
+        scoreGains[i] = int(uint32_t(gains[i]));
+    }
+}
+
+bool simdMoveAvailable()
+{
+    return SDL_HasSSE41() == SDL_TRUE;
+}
+
+bool avx2MoveAvailable()
+{
+    return SDL_HasAVX2() == SDL_TRUE;
+}
+
+#else
+
+bool moveBoardSimd(Board &board, Direction dir, int &scoreGain)
+{
+    return moveBoardTable(board, dir, scoreGain);
+}
+
+void moveBoardsAvx2(const Board *boards, const uint8_t *dirs, Board *results, int *scoreGains)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        results[i] = boards[i];
+        moveBoardTable(results[i], Direction(dirs[i] & 3), scoreGains[i]);
+    }
+}
+
+bool simdMoveAvailable()
+{
+    return false;
+}
+
+bool avx2MoveAvailable()
+{
+    return false;
+}
+
+#endif
+
+static bool moveBoardTableKernel(Board &board, Direction dir, int &scoreGain)
+{
+    return moveBoardTable(board, dir, scoreGain);
+}
+
+MoveKernel selectMoveKernel(bool simd)
+{
+    return simd && simdMoveAvailable() ? moveBoardSimd : moveBoardTableKernel;
+}
+
+// Bảng tra vẫn nhanh hơn cả khi phải tranh cache với bảng đánh giá và bảng nhớ tạm:
+// --bench search được 44 so với 28 M nodes/s, có bảng nhớ 64 MB là 33 so với 21 M nodes/s;
+// trên bàn cờ giữa ván ở độ sâu 4 cũng vậy (47 so với 26)
+MoveKernel bestMoveKernel()
+{
+    return selectMoveKernel(false);
+}
@@ -0,0 +1,53 @@
+#include "move_table.h"
+
+constexpr RowTables leftRowTables(false);
+constexpr RowTables rightRowTables(true);
+
+bool moveBoardTable(Board &board, Direction dir, int &scoreGain, MoveResult *result)
+{
+    bool vertical = dir == DIR_UP || dir == DIR_DOWN;
+    const RowTables &tables = (dir == DIR_UP || dir == DIR_LEFT) ? leftRowTables : rightRowTables;
+
+    Board rows = vertical ? transposeBoard(board) : board;
+    Board next = 0;
+    scoreGain = 0;
+
+    for (int r = 0; r < BOARD_SIZE; ++r)
+    {
+        int row = (rows >> (16 * r)) & 0xFFFF;
+        next |= Board(tables.result[row]) << (16 * r);
+        scoreGain += tables.score[row];
+    }
+
+    if (vertical)
+    {
+        next = transposeBoard(next);
+    }
+
+    bool moved = next != board;
+    if (result)
+    {
+        result->reset();
+        result->moved = moved;
+        result->scoreGain = scoreGain;
+        for (int r = 0; r < BOARD_SIZE; ++r)
+        {
+            int row = (rows >> (16 * r)) & 0xFFFF;
+            for (int k = 0; k < BOARD_SIZE; ++k)
+            {
+                // Trong bàn cờ đã chuyển vị, ô (r, k) là ô (k, r) của bàn cờ gốc
+                int cell = vertical ? k * BOARD_SIZE + r : r * BOARD_SIZE + k;
+                int to = (tables.targets[row] >> (2 * k)) & 3;
+                if (to != k && ((row >> (4 * k)) & 0xF) != 0)
+                {
+                    result->add(cell, vertical ? to * BOARD_SIZE + r : r * BOARD_SIZE + to);
+                }
+                result->mergeMask |= uint64_t((tables.merges[row] >> k) & 1) << cell;
+            }
+        }
+        result->markMerges();
+    }
+
+    board = next;
+    return moved;
+}
@@ -0,0 +1,121 @@
+#include "transposition.h"
+#include "zobrist.h"
+#include <cstring>
+
+static uint64_t packEntry(float value, float probability, int depth, int generation)
+{
+    uint32_t valueBits;
+    memcpy(&valueBits, &value, sizeof(valueBits));
+    uint64_t quantized = probability >= 1 ? 65535 : uint64_t(probability * 65535);
+    return valueBits | (quantized << 32) | (uint64_t(depth) << 48) | (uint64_t(generation) << 56);
+}
+
+static float entryValue(uint64_t data)
+{
+    uint32_t valueBits = uint32_t(data);
+    float value;
+    memcpy(&value, &valueBits, sizeof(value));
+    return value;
+}
+
+static int entryProbability(uint64_t data)
+{
+    return (data >> 32) & 0xFFFF;
+}
+
+static int entryDepth(uint64_t data)
+{
+    return (data >> 48) & 0xFF;
+}
+
+static int entryGeneration(uint64_t data)
+{
+    return data >> 56;
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes) : indexBits_(0), generation_(0)
+{
+    size_t bytes = megabytes << 20;
+    while ((sizeof(TranspositionBucket) << (indexBits_ + 1)) <= bytes)
+    {
+        ++indexBits_;
+    }
+    bucketCount_ = size_t(1) << indexBits_;
+    buckets_.reset(new TranspositionBucket[bucketCount_]);
+    clear();
+}
+
+void TranspositionTable::newSearch()
+{
+    generation_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t b = 0; b < bucketCount_; ++b)
+    {
+        for (TranspositionEntry &entry : buckets_[b].entries)
+        {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Khóa là bàn cờ chứ không phải khóa Zobrist nên cần trộn đủ trước khi lấy chỉ số
+TranspositionBucket &TranspositionTable::bucket(Board key) const
+{
+    return buckets_[tableIndex<HASH_MIX_FULL>(key, indexBits_)];
+}
+
+bool TranspositionTable::probe(Board key, int depth, float minProbability, float &value) const
+{
+    for (const TranspositionEntry &entry : bucket(key).entries)
+    {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || entryDepth(data) == 0)
+        {
+            continue;
+        }
+        if (entryDepth(data) < depth || entryProbability(data) < minProbability * 65535)
+        {
+            return false;
+        }
+        value = entryValue(data);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(Board key, int depth, float probability, float value)
+{
+    TranspositionBucket &b = bucket(key);
+    int generation = generation_.load(std::memory_order_relaxed);
+    TranspositionEntry *victim = &b.entries[0];
+    int victimScore = 1 << 30;
+    for (TranspositionEntry &entry : b.entries)
+    {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && entryDepth(data) != 0)
+        {
+            if (entryDepth(data) > depth)
+            {
+                return;
+            }
+            victim = &entry;
+            break;
+        }
+        // Mục trống thay trước, rồi tới mục của lượt cũ, rồi mục nông nhất
+        int score = entryDepth(data) == 0 ? -1 : entryDepth(data) + (entryGeneration(data) == generation ? 256 : 0);
+        if (score < victimScore)
+        {
+            victimScore = score;
+            victim = &entry;
+        }
+    }
+    uint64_t data = packEntry(value, probability, depth, generation);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
@@ -0,0 +1,118 @@
+#include "work_pool.h"
+
+// Chỉ số deque của luồng hiện tại trong pool; luồng ngoài pool dùng deque 0
+static thread_local const WorkPool *currentPool = nullptr;
+static thread_local int currentIndex = 0;
+
+WorkPool::WorkPool(int threads) : queued_(0), stopping_(false)
+{
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    for (int i = 0; i < threads; ++i)
+    {
+        queues_.emplace_back(new WorkerQueue);
+    }
+    for (int i = 1; i < threads; ++i)
+    {
+        workers_.emplace_back(&WorkPool::workerLoop, this, i);
+    }
+}
+
+WorkPool::~WorkPool()
+{
+    stopping_ = true;
+    {
+        std::lock_guard<std::mutex> guard(sleepLock_);
+        wakeUp_.notify_all();
+    }
+    for (std::thread &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+int WorkPool::queueIndex() const
+{
+    return currentPool == this ? currentIndex : 0;
+}
+
+void WorkPool::submit(TaskGroup &group, void (*run)(void *arg), void *arg)
+{
+    group.pending.fetch_add(1);
+    WorkerQueue &queue = *queues_[queueIndex()];
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(Task{run, arg, &group});
+    }
+    queued_.fetch_add(1);
+    // Đi qua sleepLock_ để luồng vừa thấy hàng đợi rỗng chắc chắn đã ngủ trước khi được đánh thức
+    {
+        std::lock_guard<std::mutex> guard(sleepLock_);
+    }
+    wakeUp_.notify_one();
+}
+
+bool WorkPool::runOne(int self)
+{
+    Task task;
+    bool found = false;
+    {
+        WorkerQueue &own = *queues_[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    for (int k = 1; !found && k < threads(); ++k)
+    {
+        WorkerQueue &victim = *queues_[(self + k) % threads()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        return false;
+    }
+    queued_.fetch_sub(1);
+    task.run(task.arg);
+    task.group->pending.fetch_sub(1);
+    return true;
+}
+
+void WorkPool::wait(TaskGroup &group)
+{
+    int self = queueIndex();
+    while (group.pending.load() > 0)
+    {
+        if (!runOne(self))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void WorkPool::workerLoop(int index)
+{
+    currentPool = this;
+    currentIndex = index;
+    while (!stopping_)
+    {
+        if (runOne(index))
+        {
+            continue;
+        }
+        // Hết việc thì ngủ tới khi có task mới
+        std::unique_lock<std::mutex> guard(sleepLock_);
+        wakeUp_.wait(guard, [this]() { return stopping_ || queued_.load() > 0; });
+    }
+}